@@ -1,116 +1,245 @@
 #include "passenger_routing.h++"
 
-#include <algo/schedule_to_graph_adapter.h++>
 #include <algo/scheduler.h++>
-#include <util/graph_utils.h++>
+#include <algo/timetable.h++>
 #include <util/logging.h++>
+#include <util/metrics.h++>
 #include <util/routing_utils.h++>
+#include <util/thread_utils.h++>
 
-#include <list>
-
-using STGA = ::algo::ScheduleToGraphAdapter;
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <mutex>
 
 namespace algo {
 
 namespace {
-	struct found_goal {
-		STGA::vertex_descriptor vd;
-	}; // exception for termination
+	// TODO get delay as a function of station & train
+	const TrackNetwork::Time alighting_time = 1;
+
+	/**
+	 * How a station was got to sooner than before in one round of the search,
+	 * ie. with one more train than the round before.
+	 */
+	struct StationLabel {
+		TrackNetwork::Time arrival;
+
+		// how we got here. board_stop is INVALID_STOP for the start station
+		Timetable::StopIndex board_stop;
+		TrainIndex train_index;
+
+		StationLabel()
+			: arrival(TrackNetwork::INVALID_TIME)
+			, board_stop(Timetable::INVALID_STOP)
+			, train_index(-1)
+		{ }
 
-	// exception type in the case of a no-route
-	struct no_route {
+		bool isReached() const { return arrival != TrackNetwork::INVALID_TIME; }
 	};
 
-	// visitor that causes the algo to terminate when we find the goal vertex (ignores time)
-	class astar_goal_visitor : public boost::default_astar_visitor {
-	private:
-		TrackNetwork::Time start_time;
-		TrackNetwork::NodeID goal_vertex;
-
-		::StationMap<TrackNetwork::Time> earliest_seen_time_at_station;
-	public:
-		astar_goal_visitor(TrackNetwork::Time start, TrackNetwork::NodeID goal, const TrackNetwork& tn)
-			: start_time(start)
-			, goal_vertex(goal)
-			, earliest_seen_time_at_station(tn.makeStationMap<TrackNetwork::Time>(TrackNetwork::INVALID_TIME))
-		{ }
+	PassengerRoutes::InternalRouteType extract_path(
+		const TrackNetwork::NodeID start_vertex,
+		const TrackNetwork::NodeID goal_vertex,
+		const std::vector<std::vector<StationLabel>>& labels_by_round,
+		const Timetable& timetable,
+		const TrackNetwork& tn
+	);
+
+	/**
+	 * The time of the first train that is at vertex at or after t, and that
+	 * goes somewhere from there, or the max Time if there never is one.
+	 */
+	TrackNetwork::Time first_train_at_or_after(const Timetable& timetable, TrackNetwork::NodeID vertex, TrackNetwork::Time t) {
+		auto result = std::numeric_limits<TrackNetwork::Time>::max();
+		for (const auto& stop : timetable.getStopsAt(vertex)) {
+			if (timetable.getNextStop(stop) != Timetable::INVALID_STOP) {
+				result = std::min(result, timetable.getArrivalTime(stop, timetable.getFirstTrainArrivingAtOrAfter(stop, t)));
+			}
+		}
+		return result;
+	}
+} // end anonymous namespace
 
-		// caled right after vd is poped off the heap, before any operaitons, eg. expansion.
-		void examine_vertex(STGA::vertex_descriptor vd, ScheduleToGraphAdapter const& g) {
-			(void)g;
-			dout(DL::PR_D3) << "Exploring " << std::tie(vd,g.getTrackNetwork()) << "..." << '\n';
+struct RouteTroughScheduleCache {
+	/**
+	 * A route found by a search that started at some time t, which is also the
+	 * route a search would find for any start time in [t, valid_until]
+	 */
+	struct CachedRoute {
+		TrackNetwork::Time valid_until;
+		PassengerRoutes::RouteType route;
+	};
 
-			// TODO: make note of this vertex in the Network, and then in the heuristic,
-			// mark up the cost a bunch, if it sees it.
-			// may need to use vis.finish_vertex(v, g); instead.
+	// keyed by the start time of the search that found it
+	using Profile = std::map<TrackNetwork::Time, CachedRoute>;
+	using ODPair = std::pair<TrackNetwork::NodeID, TrackNetwork::NodeID>;
 
-			if (vd.getLocation().isStation()) {
-				auto& earliest_seen_time_at_this_station = earliest_seen_time_at_station[vd.getLocation().asStationID().getValue()];
-				if (
-					   earliest_seen_time_at_this_station == TrackNetwork::INVALID_TIME
-					|| vd.getTime() > earliest_seen_time_at_this_station
-				) {
-					earliest_seen_time_at_this_station = vd.getTime();
+	struct ODPairHash {
+		size_t operator()(const ODPair& od_pair) const {
+			return std::hash<TrackNetwork::NodeID>()(od_pair.first) * 31 + std::hash<TrackNetwork::NodeID>()(od_pair.second);
+		}
+	};
+
+	// guards everything below
+	std::mutex mutex;
+
+	// compiled on first use, and re-compiled if used with a different Schedule.
+	// shared, so that a thread can keep using one while another replaces it
+	std::shared_ptr<const Timetable> timetable;
+
+	// only valid for timetable
+	std::unordered_map<ODPair, Profile, ODPairHash> profiles;
+
+	RouteTroughScheduleCache() : mutex(), timetable(), profiles() { }
+
+	std::shared_ptr<const Timetable> getTimetableFor(const Schedule& sch, const TrackNetwork& tn) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!timetable || !timetable->isCompiledFrom(sch)) {
+			timetable = std::make_shared<const Timetable>(sch, tn);
+			profiles.clear();
+		}
+		return timetable;
+	}
+
+	void forgetRoutesBefore(TrackNetwork::Time t) {
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto profile_it = profiles.begin(); profile_it != profiles.end(); ) {
+			auto& profile = profile_it->second;
+			for (auto cached = profile.begin(); cached != profile.end(); ) {
+				if (cached->second.valid_until < t) {
+					cached = profile.erase(cached);
+				} else {
+					++cached;
 				}
 			}
+			if (profile.empty()) {
+				profile_it = profiles.erase(profile_it);
+			} else {
+				++profile_it;
+			}
+		}
+	}
+
+	size_t getNumRoutes() {
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t num_routes = 0;
+		for (const auto& od_pair_and_profile : profiles) {
+			num_routes += od_pair_and_profile.second.size();
+		}
+		return num_routes;
+	}
 
-			if (vd.getVertex() == goal_vertex && vd.getLocation().isStation()) {
-				throw found_goal{vd};
-			} else if (vd.getTime() > (start_time + 100)) {
-				throw no_route();
+	PassengerRoutes::RouteType route(
+		const TrackNetwork& tn,
+		const Schedule& sch,
+		const TrackNetwork::Time start_time,
+		const TrackNetwork::NodeID start_vertex,
+		const TrackNetwork::NodeID goal_vertex
+	) {
+		const auto timetable_used = getTimetableFor(sch, tn);
+		const auto od_pair = std::make_pair(start_vertex, goal_vertex);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			const auto profile_find_results = profiles.find(od_pair);
+			if (timetable == timetable_used && profile_find_results != profiles.end()) {
+				const auto& profile = profile_find_results->second;
+				auto cached = profile.upper_bound(start_time);
+				if (cached != profile.begin() && start_time <= std::prev(cached)->second.valid_until) {
+					auto route = std::prev(cached)->second.route;
+					if (!route.empty()) {
+						route.front() = PassengerRoutes::RouteElement(route.front().getLocation(), start_time);
+					}
+					dout(DL::PR_D2) << "re-using route found for t=" << std::prev(cached)->first << '\n';
+					metrics::count(metrics::Counter::ROUTES_FROM_CACHE);
+					return route;
+				}
 			}
 		}
 
-		bool haveVisitedStationOfVertex(const STGA::vertex_descriptor& vd) {
-			assert(vd.getLocation().isStation() == true);
-			return earliest_seen_time_at_station[vd.getLocation().asStationID().getValue()] != TrackNetwork::INVALID_TIME;
+		// search without the lock held
+		auto route = route_through_schedule(tn, *timetable_used, start_time, start_vertex, goal_vertex);
+
+		// The start time only matters for which trains can be caught at the start station,
+		// so a search from any time up to when the next train comes by there sees exactly
+		// the same trains, and finds exactly the same route. After that, this route may
+		// still be the quickest, but a search might pick another just as quick one, so
+		// it isn't used, as the answers shouldn't depend on what was asked before.
+		// Trains repeat forever, so if there is no route now, there never will be.
+		const auto valid_until = [&]() {
+			if (route.empty() || route.size() == 1) {
+				return std::numeric_limits<TrackNetwork::Time>::max();
+			} else {
+				return first_train_at_or_after(*timetable_used, start_vertex, start_time);
+			}
+		}();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// don't store it if another thread changed the schedule in the mean time
+			if (timetable == timetable_used) {
+				profiles[od_pair].emplace(start_time, CachedRoute{valid_until, route});
+			}
 		}
-	};
 
-	template<typename PRED_MAP>
-	PassengerRoutes::InternalRouteType extract_coalesced_path(
-		const STGA::vertex_descriptor& start,
-		const STGA::vertex_descriptor& end,
-		const PRED_MAP& pred_map,
-		const TrackNetwork& tn
-	);
-} // end anonymous namespace
+		return route;
+	}
+};
+
+// These are declared here because the need to be after the definition of RouteTroughScheduleCache
+RouteTroughScheduleCacheHandle::RouteTroughScheduleCacheHandle(RouteTroughScheduleCacheHandle&&) = default;
+RouteTroughScheduleCacheHandle& RouteTroughScheduleCacheHandle::operator=(RouteTroughScheduleCacheHandle&&) = default;
+RouteTroughScheduleCacheHandle::RouteTroughScheduleCacheHandle() = default;
+RouteTroughScheduleCacheHandle::~RouteTroughScheduleCacheHandle() { }
+
+void forget_cached_routes_before(const RouteTroughScheduleCacheHandle& cache_handle, TrackNetwork::Time t) {
+	if (cache_handle) {
+		cache_handle->forgetRoutesBefore(t);
+	}
+}
+
+size_t get_num_cached_routes(const RouteTroughScheduleCacheHandle& cache_handle) {
+	return cache_handle ? cache_handle->getNumRoutes() : 0;
+}
 
-PassengerRoutes route_passengers(
+std::pair<
+	PassengerRoutes,
+	RouteTroughScheduleCacheHandle
+> route_passengers(
 	const TrackNetwork& tn,
 	const Schedule& sch,
-	const PassengerList& passgrs
+	const PassengerList& passgrs,
+	RouteTroughScheduleCacheHandle&& cache_handle,
+	size_t num_threads
 ) {
-	// { boost::concepts::IncidenceGraphConcept<ScheduleToGraphAdapter> c; (void)c; }
-
 	auto rp_indent = dout(DL::PR_D1).indentWithTitle("Passenger Routing");
+	metrics::ScopedTimer timer(metrics::Phase::ROUTE);
 
-	PassengerRoutes results;
+	// if null, create a cache
+	if (!cache_handle) { cache_handle = std::make_unique<::algo::RouteTroughScheduleCache>(); }
+
+	// the debug output would get all mixed up, and the searches and cache look ups have some too
+	if (dout(DL::PR_D1).enabled() || dout(DL::PR_D2).enabled() || dout(DL::PR_D3).enabled() || dout(DL::PR_D4).enabled()) {
+		num_threads = 1;
+	}
 
-	RouteTroughScheduleCacheHandle cache_handle;
-	for (auto passenger : passgrs) {
+	std::vector<PassengerRoutes::RouteType> routes(passgrs.size());
+	::util::parallel_for_index(passgrs.size(), num_threads, [&](size_t ipassenger) {
+		const auto& passenger = passgrs[ipassenger];
 		auto pass_indent = dout(DL::PR_D1).indentWithTitle([&](auto&& s){ s << "Passenger " << passenger.getName(); });
 
-		PassengerRoutes::RouteType route;
-		std::tie(route, cache_handle) = route_through_schedule(tn, sch, passenger.getStartTime(), passenger.getEntryID(), passenger.getExitID(), std::move(cache_handle));
-		results.addRoute(passenger, std::move(route));
+		routes[ipassenger] = route_through_schedule(tn, sch, passenger.getStartTime(), passenger.getEntryID(), passenger.getExitID(), cache_handle);
+	});
+
+	PassengerRoutes results;
+	for (size_t ipassenger = 0; ipassenger != passgrs.size(); ++ipassenger) {
+		results.addRoute(passgrs[ipassenger], std::move(routes[ipassenger]));
 	}
 
-	return results;
+	return { std::move(results), std::move(cache_handle) };
 }
 
-struct RouteTroughScheduleCache {
-	// uh... empty for now
-	// if the STGA is cached (which is pointless?), or paths are, then there
-	// would have to be some checksum type thing on the Schedule & TN...
-};
-
-// These are declared here because the need to be after the definition of RouteTroughScheduleCache
-RouteTroughScheduleCacheHandle::RouteTroughScheduleCacheHandle(RouteTroughScheduleCacheHandle&&) = default;
-RouteTroughScheduleCacheHandle& RouteTroughScheduleCacheHandle::operator=(RouteTroughScheduleCacheHandle&&) = default;
-RouteTroughScheduleCacheHandle::RouteTroughScheduleCacheHandle() = default;
-RouteTroughScheduleCacheHandle::~RouteTroughScheduleCacheHandle() { }
-
 std::pair<
 	PassengerRoutes::RouteType,
 	RouteTroughScheduleCacheHandle
@@ -126,122 +255,192 @@ std::pair<
 	// if null, create a cache
 	if (!cache_handle) { cache_handle = std::make_unique<::algo::RouteTroughScheduleCache>(); }
 
-	auto start_vertex_and_time = STGA::vertex_descriptor(start_vertex,start_time,tn);
+	auto route = route_through_schedule(tn, sch, start_time, start_vertex, goal_vertex, cache_handle);
 
-	auto my_visitor = astar_goal_visitor(start_vertex_and_time.getTime(), goal_vertex, tn);
+	return { std::move(route), std::move(cache_handle) };
+}
 
-	auto heuristic = ::util::make_astar_heuristic<ScheduleToGraphAdapter>(
-		[&](const STGA::vertex_descriptor& vd) -> TrackNetwork::Weight {
-			(void)vd;
-			if (vd.getLocation().isStation() && my_visitor.haveVisitedStationOfVertex(vd)) {
-				return 100000;
-			} else {
-				return 1;
+PassengerRoutes::RouteType route_through_schedule(
+	const TrackNetwork& tn,
+	const Schedule& sch,
+	const TrackNetwork::Time start_time,
+	const TrackNetwork::NodeID start_vertex,
+	const TrackNetwork::NodeID goal_vertex,
+	const RouteTroughScheduleCacheHandle& cache_handle
+) {
+	if (cache_handle) {
+		return cache_handle->route(tn, sch, start_time, start_vertex, goal_vertex);
+	} else {
+		return route_through_schedule(tn, Timetable(sch, tn), start_time, start_vertex, goal_vertex);
+	}
+}
+
+PassengerRoutes::RouteType route_through_schedule(
+	const TrackNetwork& tn,
+	const Timetable& timetable,
+	const TrackNetwork::Time start_time,
+	const TrackNetwork::NodeID start_vertex,
+	const TrackNetwork::NodeID goal_vertex
+) {
+	dout(DL::PR_D2) << "Start vertex and time: " << tn.getVertexName(start_vertex) << "@t=" << start_time << '\n';
+	dout(DL::PR_D2) << "Goal vertex: " << tn.getVertexName(goal_vertex) << '(' << goal_vertex << ")\n";
+
+	// Rounds over the stations, like RAPTOR: round k finds when each station can be got to
+	// sooner than before by taking a k-th train, by boarding the first train of each route
+	// that comes by after each station that got sooner in round k-1. So the first round
+	// that gets to the goal at its earliest time is also the fewest trains that can.
+	// (Dijkstra over (arrival, boardings) labels can't promise that, as it throws away
+	// later arrivals with fewer boardings, which may still catch the same train.)
+	// Every round has to get somewhere sooner than before, so this always ends, even
+	// with no limit on how long the trip may take.
+	const auto never = std::numeric_limits<TrackNetwork::Time>::max();
+	std::vector<TrackNetwork::Time> earliest_arrivals(timetable.getNumVertices(), never);
+	std::vector<std::vector<StationLabel>> labels_by_round(1, std::vector<StationLabel>(timetable.getNumVertices()));
+	std::vector<TrackNetwork::NodeID> got_sooner{start_vertex};
+
+	earliest_arrivals[start_vertex] = start_time;
+	labels_by_round[0][start_vertex].arrival = start_time;
+
+	metrics::count(metrics::Counter::ROUTE_SEARCHES);
+	uint64_t num_expansions = 0;
+
+	while (!got_sooner.empty()) {
+		labels_by_round.emplace_back(timetable.getNumVertices());
+		const auto& last_round = labels_by_round[labels_by_round.size() - 2];
+		auto& this_round = labels_by_round.back();
+		std::vector<TrackNetwork::NodeID> got_sooner_this_round;
+
+		// for each train taken this round, the earliest stop it was boarded at. If it has already
+		// been boarded at or before a stop, then everything it could reach has already been looked at.
+		::algo::TrainMap<Timetable::StopIndex> earliest_boarding_of_train;
+
+		for (const auto& curr_vertex : got_sooner) {
+			num_expansions += 1;
+			const auto& curr_label = last_round[curr_vertex];
+			dout(DL::PR_D3) << "Exploring " << tn.getVertexName(curr_vertex) << "@t=" << curr_label.arrival << "...\n";
+
+			for (const auto& board_stop : timetable.getStopsAt(curr_vertex)) {
+				if (timetable.getNextStop(board_stop) == Timetable::INVALID_STOP) {
+					continue; // the train ends here
+				}
+
+				const auto train_index = timetable.getFirstTrainArrivingAtOrAfter(board_stop, curr_label.arrival);
+				const auto train_id = ::util::make_id<TrainID>(timetable.getRouteOf(board_stop), train_index);
+
+				auto boarding_find_results = earliest_boarding_of_train.find(train_id);
+				auto scan_until = Timetable::INVALID_STOP;
+				if (boarding_find_results == earliest_boarding_of_train.end()) {
+					earliest_boarding_of_train.emplace(train_id, board_stop);
+				} else if (boarding_find_results->second <= board_stop) {
+					continue;
+				} else {
+					scan_until = boarding_find_results->second;
+					boarding_find_results->second = board_stop;
+				}
+
+				dout(DL::PR_D4) << "\tcan take " << train_id << " at t=" << timetable.getArrivalTime(board_stop, train_index) << '\n';
+
+				for (
+					auto alight_stop = timetable.getNextStop(board_stop);
+					alight_stop != Timetable::INVALID_STOP;
+					alight_stop = timetable.getNextStop(alight_stop)
+				) {
+					const auto next_vertex = timetable.getVertexOf(alight_stop);
+					const auto next_arrival = timetable.getArrivalTime(alight_stop, train_index) + alighting_time;
+
+					// getting somewhere no sooner than the goal can't help get to the goal sooner
+					if (next_arrival < earliest_arrivals[next_vertex] && next_arrival < earliest_arrivals[goal_vertex]) {
+						earliest_arrivals[next_vertex] = next_arrival;
+						auto& next_label = this_round[next_vertex];
+						if (!next_label.isReached()) {
+							got_sooner_this_round.push_back(next_vertex);
+						}
+						next_label.arrival = next_arrival;
+						next_label.board_stop = board_stop;
+						next_label.train_index = train_index;
+					}
+
+					if (alight_stop == scan_until) {
+						break;
+					}
+				}
 			}
 		}
-	);
 
-	dout(DL::PR_D2) << "Start vertex and time: " << std::tie(start_vertex_and_time,tn) << '\n';
-	dout(DL::PR_D2) << "Goal vertex: " << tn.getVertexName(goal_vertex) << '(' << goal_vertex << ")\n";
+		got_sooner = std::move(got_sooner_this_round);
+	}
 
-	const TrackNetwork::Time station_lookahead_quanta = 5; // TODO calculate station_lookahead_quanta from... something
-	const ScheduleToGraphAdapter baseGraph(tn,sch,station_lookahead_quanta);
-
-	auto pred_map = baseGraph.make_pred_map();
-	auto backing_distance_map = baseGraph.make_backing_distance_map(start_vertex_and_time);
-	auto backing_rank_map = baseGraph.make_backing_rank_map(heuristic);
-	auto backing_colour_map = baseGraph.make_backing_colour_map();
-
-	try {
-		// use the tree one, because we don't have a way to generate unique indexes for
-		// vertexes that are on-train ones. Note: this is less efficient, because nothing
-		// keeps track of the "closed" vertexes - if we arrive at the a station at a part-
-		// icular time more than one way, then we will re-explore from there every time.
-		astar_search_no_init_tree(
-			baseGraph,
-			start_vertex_and_time,
-			heuristic
-			, visitor(::util::make_ref_astar_visitor(my_visitor))
-			. distance_map(baseGraph.make_distance_map(backing_distance_map))
-			. predecessor_map(std::ref(pred_map)) // don't want to pass by value
-			. rank_map(baseGraph.make_rank_map(backing_rank_map))
-			. color_map(baseGraph.make_colour_map(backing_colour_map))
-		);
-	} catch (const found_goal& fg) { // found a path to the goal
-		return { extract_coalesced_path(start_vertex_and_time, fg.vd, pred_map, tn), std::move(cache_handle) };
-	} catch (const no_route&) {
-		// do nothing
+	if (earliest_arrivals[goal_vertex] != never) {
+		metrics::record(metrics::Distribution::ROUTE_SEARCH_EXPANSIONS, num_expansions);
+		return extract_path(start_vertex, goal_vertex, labels_by_round, timetable, tn);
 	}
 
-	dout(DL::PR_D1) << "Didn't find a path from " << std::tie(start_vertex_and_time,tn) << " to " << tn.getVertexName(goal_vertex) << '\n';
+	metrics::record(metrics::Distribution::ROUTE_SEARCH_EXPANSIONS, num_expansions);
+
+	dout(DL::PR_D1) << "Didn't find a path from " << tn.getVertexName(start_vertex) << "@t=" << start_time << " to " << tn.getVertexName(goal_vertex) << '\n';
+
+	return PassengerRoutes::RouteType();
+}
 
-	return { PassengerRoutes::RouteType(), std::move(cache_handle) };
+std::vector<StatisticalPassenger> get_served_demand(
+	const TrackNetwork& tn,
+	const Schedule& sch,
+	const std::vector<StatisticalPassenger>& demand
+) {
+	const Timetable timetable(sch, tn);
+	std::vector<StatisticalPassenger> result;
+	for (const auto& passenger : demand) {
+		// trains repeat forever, so if there is a route at one time, there is one at any time
+		if (route_through_schedule(tn, timetable, 0, passenger.getEntryID(), passenger.getExitID()).empty() == false) {
+			result.push_back(passenger);
+		}
+	}
+	return result;
 }
 
 namespace {
 
-template<typename PRED_MAP>
-PassengerRoutes::InternalRouteType extract_coalesced_path(
-	const STGA::vertex_descriptor& start,
-	const STGA::vertex_descriptor& end,
-	const PRED_MAP& pred_map,
+PassengerRoutes::InternalRouteType extract_path(
+	const TrackNetwork::NodeID start_vertex,
+	const TrackNetwork::NodeID goal_vertex,
+	const std::vector<std::vector<StationLabel>>& labels_by_round,
+	const Timetable& timetable,
 	const TrackNetwork& tn
 ) {
-	STGA::vertex_descriptor prev = end;
-
 	PassengerRoutes::InternalRouteType path;
-	path.emplace_back(prev.getLocation(), prev.getTime());
 
-	dout(DL::PR_D1) << "path found: ";
-	dout(DL::PR_D3) << std::tie(prev,tn);
+	// the last round that got to the goal sooner is the one that got there soonest
+	auto round = labels_by_round.size() - 1;
+	while (!labels_by_round[round][goal_vertex].isReached()) {
+		round -= 1;
+	}
 
+	// walk backwards, adding the station then the train that got us there,
+	// which was boarded somewhere that the round before got to
+	auto curr_vertex = goal_vertex;
 	while (true) {
-		STGA::vertex_descriptor vd = get(pred_map,prev);
-		if(prev == vd) { // we have reached the beginning
-			prev = vd;
-			break;
-		}
+		const auto& label = labels_by_round[round][curr_vertex];
+		path.emplace_back(tn.getStationIDByVertexID(curr_vertex), label.arrival);
 
-		if (
-			   (vd.getLocation().isStation() && prev.getLocation().isStation())
-			&& (vd.getLocation() != prev.getLocation())
-		) {
-			::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
-				str << "going from a Station to a different Station: " << std::tie(prev,tn) << " <- " << std::tie(vd,tn);
-			});
-		}
-		if (
-			   (vd.getLocation().isTrain() && prev.getLocation().isTrain())
-			&& (vd.getLocation() != prev.getLocation())
-		) {
-			::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
-				str << "going from a Train to a different Train: " << std::tie(prev,tn) << " <- " << std::tie(vd,tn);
-			});
-		}
-		if (vd.getTime() > prev.getTime()) {
-			::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
-				str << "time went backwards!: " << std::tie(prev,tn) << " <- " << std::tie(vd,tn);
-			});
+		if (label.board_stop == Timetable::INVALID_STOP) {
+			break;
 		}
 
-		// we want to keep the first one (time-wise), so keep the last one we see
-		// (keep replacing until the location changes);
-		if (vd.getLocation() == path.back().getLocation()) {
-			path.back() = PassengerRoutes::RouteElement(vd.getLocation(), vd.getTime());
-		} else {
-			path.emplace_back(vd.getLocation(), vd.getTime());
-		}
-		dout(DL::PR_D3) << " <- " << std::tie(vd,tn);
-		prev = vd;
+		path.emplace_back(
+			::util::make_id<TrainID>(timetable.getRouteOf(label.board_stop), label.train_index),
+			timetable.getArrivalTime(label.board_stop, label.train_index)
+		);
+		curr_vertex = timetable.getVertexOf(label.board_stop);
+		round -= 1;
 	}
-	dout(DL::PR_D3) << "\n\t = ";
 
-	if (prev != start) {
+	if (curr_vertex != start_vertex) {
 		dout(DL::WARN) << "begin vertex is not the start!\n";
 	}
 
 	std::reverse(path.begin(),path.end()); // was backwards
 
+	dout(DL::PR_D1) << "path found: ";
 	::util::print_route_of_route_elements(path, tn, dout(DL::PR_D1));
 	dout(DL::PR_D1) << '\n';
 
@@ -12,6 +12,7 @@
 namespace algo {
 
 class Schedule;
+class Timetable;
 
 class PassengerRoutes {
 public:
@@ -66,13 +67,11 @@ public:
 	bool hasRoute(const Passenger& p) const {
 		return routes.find(p.getID()) != end(routes);
 	}
-};
 
-PassengerRoutes route_passengers(
-	const TrackNetwork& tn,
-	const Schedule& sch,
-	const PassengerList& passgrs
-);
+	void removeRoute(const Passenger& p) {
+		routes.erase(p.getID());
+	}
+};
 
 struct RouteTroughScheduleCache;
 struct RouteTroughScheduleCacheHandle : public ::util::unique_handle<RouteTroughScheduleCache> {
@@ -84,6 +83,29 @@ struct RouteTroughScheduleCacheHandle : public ::util::unique_handle<RouteTrough
 	~RouteTroughScheduleCacheHandle();
 };
 
+/**
+ * Route every passenger in passgrs, spread over num_threads threads (0 means
+ * use all cores). sch and tn are only read, and all threads share the cache.
+ */
+std::pair<
+	PassengerRoutes,
+	RouteTroughScheduleCacheHandle
+> route_passengers(
+	const TrackNetwork& tn,
+	const Schedule& sch,
+	const PassengerList& passgrs,
+	RouteTroughScheduleCacheHandle&& cache_handle = RouteTroughScheduleCacheHandle(),
+	size_t num_threads = 0
+);
+
+/**
+ * Routes using (and filling) the cache in cache_handle, creating one if it is null.
+ * A cache remembers routes for each (entry, exit) pair, and will answer any later
+ * query that starts between a remembered query's start time and the time the next
+ * train comes by its entry without doing a search, as a search would find exactly
+ * the same route. So the answers never depend on what was asked before, or in what
+ * order. It is cleared if used with a different Schedule.
+ */
 std::pair<
 	PassengerRoutes::RouteType,
 	RouteTroughScheduleCacheHandle
@@ -96,6 +118,55 @@ std::pair<
 	RouteTroughScheduleCacheHandle&& cache_handle = RouteTroughScheduleCacheHandle()
 );
 
+/**
+ * Forget the cached routes that no query starting at or after t could use. For
+ * when the start times only ever go up, like in the simulator, so that the cache
+ * doesn't keep growing. Does nothing if cache_handle is null.
+ */
+void forget_cached_routes_before(const RouteTroughScheduleCacheHandle& cache_handle, TrackNetwork::Time t);
+
+/**
+ * The number of routes in the cache, over all (entry, exit) pairs
+ */
+size_t get_num_cached_routes(const RouteTroughScheduleCacheHandle& cache_handle);
+
+/**
+ * Same as above, but only borrows the cache, so that several threads can use
+ * the same one at once. If cache_handle is null, no caching is done.
+ */
+PassengerRoutes::RouteType route_through_schedule(
+	const TrackNetwork& tn,
+	const Schedule& sch,
+	const TrackNetwork::Time start_time,
+	const TrackNetwork::NodeID start_vertex,
+	const TrackNetwork::NodeID goal_vertex,
+	const RouteTroughScheduleCacheHandle& cache_handle
+);
+
+/**
+ * Find the earliest arriving route from start_vertex to goal_vertex, leaving
+ * no earlier than start_time, and of those, one that takes the fewest trains.
+ * Returns an empty route if there is none.
+ */
+PassengerRoutes::RouteType route_through_schedule(
+	const TrackNetwork& tn,
+	const Timetable& timetable,
+	const TrackNetwork::Time start_time,
+	const TrackNetwork::NodeID start_vertex,
+	const TrackNetwork::NodeID goal_vertex
+);
+
+/**
+ * The passengers in demand that sch can take from their entry to their exit.
+ * The schedulers don't guarantee to serve every pair that the network connects,
+ * and the simulator can't handle a passenger with no route.
+ */
+std::vector<StatisticalPassenger> get_served_demand(
+	const TrackNetwork& tn,
+	const Schedule& sch,
+	const std::vector<StatisticalPassenger>& demand
+);
+
 } // end namespace algo
 
 #endif /* ALGO__PASSENGER_ROUTING_HPP */
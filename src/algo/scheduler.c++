@@ -1,13 +1,15 @@
 #include "scheduler.h++"
 
-#include <algo/passenger_routing.h++>
-#include <graphics/graphics.h++>
 #include <util/graph_utils.h++>
 #include <util/iteration_utils.h++>
 #include <util/logging.h++>
+#include <util/metrics.h++>
 #include <util/routing_utils.h++>
+#include <util/thread_utils.h++>
 
 #include <boost/property_map/function_property_map.hpp>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <unordered_map>
 #include <unordered_set>
@@ -15,6 +17,26 @@
 namespace {
 	template<typename TRAIN_DATA_COLLECTION>
 	::algo::Schedule make_a_schedule__all_start_zero(const std::string& name, const TRAIN_DATA_COLLECTION& train_data, const TrackNetwork& network);
+
+	/**
+	 * A ShortestPathOracle for network, with its preprocessing counted
+	 */
+	::util::TrackNetworkShortestPathOracle make_counted_shortest_path_oracle(const TrackNetwork& network) {
+		auto oracle = ::util::make_shortest_path_oracle(network);
+		metrics::count(metrics::Counter::SHORTEST_PATH_TREES, oracle.getNumPreprocessingSearches());
+		return oracle;
+	}
+
+	/**
+	 * oracle.getRoute(args...), counted as a query
+	 */
+	template<typename... ARGS>
+	std::vector<TrackNetwork::NodeID> get_counted_route(::util::TrackNetworkShortestPathOracle& oracle, ARGS&&... args) {
+		auto route = oracle.getRoute(std::forward<ARGS>(args)...);
+		metrics::count(metrics::Counter::SHORTEST_PATH_QUERIES);
+		metrics::record(metrics::Distribution::SHORTEST_PATH_QUERY_EXPANSIONS, oracle.getNumExpandedByLastQuery());
+		return route;
+	}
 }
 
 namespace algo {
@@ -170,27 +192,200 @@ public:
 
 	using TrainDataList = std::vector<TrainData>;
 
+	/**
+	 * Where each vertex appears in a TrainDataList, so that the coalescing steps
+	 * only have to look at trains that actually share vertices, instead of
+	 * comparing every train with every other one.
+	 * Everything is listed in increasing (train index, position) order.
+	 * It is made once, and kept up to date as the steps change the trains: each
+	 * train has a slot that stays the same as trains before it are removed, so
+	 * only the vertices of trains that change have to be looked at.
+	 *
+	 * Also keeps how each pair of trains that share a vertex overlap, which is
+	 * all the steps need to know about a pair. A pair's overlaps only depend on
+	 * the two routes, so when a route changes, the pairs with the trains it shared
+	 * vertices with are marked dirty, and only those are compared again.
+	 */
+	class VertexOccurrenceIndex {
+	public:
+		struct Occurrence {
+			size_t itrain;
+			ptrdiff_t position;
+		};
+
+		/**
+		 * The two trains have the same vertex at my_start and other_start, and go
+		 * to the same vertices after that, until my_end and other_end. Only where
+		 * they start going together is kept, as every vertex after that, up to the
+		 * ends, overlaps in the same way.
+		 */
+		struct Overlap {
+			ptrdiff_t my_start;
+			ptrdiff_t other_start;
+			ptrdiff_t my_end;
+			ptrdiff_t other_end;
+		};
+
+		// in increasing (my_start, other_start) order
+		using OverlapList = std::vector<Overlap>;
+
+		VertexOccurrenceIndex(const TrainDataList& train_data, const TrackNetwork& network);
+
+		auto getOccurrencesOf(const TrackNetwork::NodeID& vertex) const {
+			const auto& list = occurrences[vertex];
+			return ::util::xrange_forward_pe<decltype(list.begin())>(list.begin(), list.end(), [this](const auto& it) {
+				return Occurrence{ train_of_slot[it->slot], it->position };
+			});
+		}
+
+		auto getTrainsStartingAt(const TrackNetwork::NodeID& vertex) const {
+			const auto& list = slots_starting_at[vertex];
+			return ::util::xrange_forward_pe<decltype(list.begin())>(list.begin(), list.end(), [this](const auto& it) {
+				return train_of_slot[*it];
+			});
+		}
+
+		/**
+		 * How itrain overlaps with iother, which it shares a vertex with. They are only
+		 * compared if they haven't been since either of their routes last changed.
+		 */
+		const OverlapList& getOverlaps(size_t itrain, size_t iother, const TrainDataList& train_data);
+
+		/**
+		 * Compare each train with the trains listed for it (in increasing order), if
+		 * getOverlaps would have to, on num_threads threads. For steps that look at a
+		 * lot of pairs at once.
+		 */
+		void compareTrains(const std::vector<std::vector<size_t>>& trains_to_compare_with, const TrainDataList& train_data, size_t num_threads);
+
+		/**
+		 * getOverlaps, for a pair that compareTrains has made sure is compared.
+		 */
+		const OverlapList& getComparedOverlaps(size_t itrain, size_t iother) const {
+			return overlaps_of_slot[slot_of_train.at(itrain)].at(slot_of_train.at(iother));
+		}
+
+		/**
+		 * Forget itrain, which has the route given. Call renumber once the trains are
+		 * removed from the TrainDataList.
+		 */
+		void removeTrain(size_t itrain, const VertexList& route);
+
+		/**
+		 * itrain's route changed from old_route to new_route.
+		 */
+		void replaceRoute(size_t itrain, const VertexList& old_route, const VertexList& new_route);
+
+		/**
+		 * itrain's route is about to be cut down to it's first new_length vertices.
+		 */
+		void truncateRoute(size_t itrain, const VertexList& route, size_t new_length);
+
+		/**
+		 * Give the remaining trains indexes from 0, in the same order as before.
+		 */
+		void renumber();
+
+	private:
+		struct SlotOccurrence {
+			size_t slot;
+			ptrdiff_t position;
+
+			bool operator<(const SlotOccurrence& rhs) const {
+				return std::tie(slot, position) < std::tie(rhs.slot, rhs.position);
+			}
+		};
+
+		// to find all of a slot's occurrences
+		struct SlotLess {
+			bool operator()(const SlotOccurrence& lhs, size_t rhs) const { return lhs.slot < rhs; }
+			bool operator()(size_t lhs, const SlotOccurrence& rhs) const { return lhs < rhs.slot; }
+		};
+
+		void addRoute(size_t slot, const VertexList& route);
+		void removeRoute(size_t slot, const VertexList& route);
+
+		/**
+		 * Where each vertex is in one train's route, so that other routes can be
+		 * compared with it by just walking along them. Re-used for many routes, with
+		 * a stamp, so that something the size of the network doesn't have to be
+		 * cleared each time.
+		 */
+		class RoutePositions {
+		public:
+			RoutePositions() : route(nullptr), stamp_of_vertex(), first_position_of_vertex(), next_position_of_same_vertex(), stamp(0) { }
+			RoutePositions(const RoutePositions&) = delete;
+			RoutePositions& operator=(const RoutePositions&) = delete;
+
+			void setRoute(const VertexList& new_route, size_t num_vertices);
+
+			/**
+			 * The overlaps of this_train_route with the route set, from this_train_route's side.
+			 */
+			OverlapList compareWith(const VertexList& this_train_route) const;
+
+		private:
+			const VertexList* route;
+			std::vector<uint64_t> stamp_of_vertex;
+			std::vector<ptrdiff_t> first_position_of_vertex;
+			std::vector<ptrdiff_t> next_position_of_same_vertex;
+			uint64_t stamp;
+		};
+
+		/**
+		 * The same overlaps, seen from the other train's side.
+		 */
+		static OverlapList reverseOverlaps(const OverlapList& overlaps);
+
+		/**
+		 * Forget the overlaps of slot with every other train. They will be compared
+		 * again if a step asks for them.
+		 */
+		void markOverlapsDirty(size_t slot);
+
+		std::vector<std::vector<SlotOccurrence>> occurrences;
+		std::vector<std::vector<size_t>> slots_starting_at;
+		std::vector<size_t> slot_of_train;
+		std::vector<size_t> train_of_slot; // NO_TRAIN if removed
+
+		// keyed by the other train's slot. Kept on both sides, so a pair is either
+		// compared from both sides, or dirty on both
+		std::vector<std::unordered_map<size_t, OverlapList>> overlaps_of_slot;
+	};
+
 private:
 	TrainDataList make_one_train_per_passenger() const;
 	TrainDataList coalesce_trains(TrainDataList&& initial_trains) const;
 
-	TrainDataList schstep_remove_redundant_trains(TrainDataList&& train_data) const;
-	TrainDataList schstep_combine_trains(TrainDataList&& train_data) const;
-	TrainDataList schstep_remove_unneeded_trains(TrainDataList&& train_data) const;
-	TrainDataList schstep_spurify(TrainDataList&& train_data) const;
+	TrainDataList schstep_remove_redundant_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const;
+	TrainDataList schstep_combine_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const;
+	TrainDataList schstep_remove_unneeded_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const;
+	TrainDataList schstep_spurify(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const;
 
 	void dump_trains_to_dout(
 		const TrainDataList& train_data,
 		const std::string& title,
 		DebugLevel::Level level
 	) const;
+
+	/**
+	 * How many threads the steps may use. Just one if the debug output they
+	 * make is enabled, as it would get all mixed up.
+	 */
+	size_t num_threads() const;
 };
 
 Scheduler3::TrainDataList remove_redundant_trains(
 	Scheduler3::TrainDataList&& train_data,
-	const std::vector<size_t>& train_is_rudundant_with
+	const std::vector<size_t>& train_is_rudundant_with,
+	Scheduler3::VertexOccurrenceIndex& vertex_occurrences
 );
 
+uint64_t Schedule::makeSerialNumber() {
+	static std::atomic<uint64_t> next_serial_number(0);
+	return next_serial_number++;
+}
+
 /**
  * Entry Point.
  *
@@ -200,6 +395,7 @@ Schedule schedule(
 	const TrackNetwork& network,
 	const std::vector<StatisticalPassenger>& passengers
 ) {
+	metrics::ScopedTimer timer(metrics::Phase::SCHEDULE);
 	return Scheduler3 (
 		network,
 		passengers,
@@ -210,13 +406,8 @@ Schedule schedule(
 Schedule Scheduler2::do_schedule() {
 	auto fnd_routes_indent = dout(DL::INFO).indentWithTitle("finding routes (scheduler2)");
 
-	auto edge_wanted_capacities_sp = util::make_shared(::util::makeEdgeMap<float>(g,float()));
-	auto& edge_wanted_capacities = *edge_wanted_capacities_sp;
-
-	edge_wanted_capacities = compute_edge_wanted_capacities();
-
-	graphics::get().trainsArea().displayTNAndWantedCapacities(edge_wanted_capacities_sp);
-	graphics::get().waitForPress();
+	// not displayed, so that the algo code can be used without graphics. See DL::WC_D1 instead
+	const auto edge_wanted_capacities = compute_edge_wanted_capacities();
 
 	auto train_routes = make_rotues(edge_wanted_capacities);
 
@@ -240,6 +431,11 @@ Scheduler2::EdgeWantedCapacities Scheduler2::compute_edge_wanted_capacities() {
 	auto edge_wanted_capacities = ::util::makeEdgeMap<float>(g,1);
 
 	auto ewc_indent = dout(DL::WC_D1).indentWithTitle("Computing Edge Wanted Capacities");
+
+	// one oracle for every passenger and iteration. Its bounds are from the unmodified
+	// weights, and iterations only ever make weights bigger, so they hold for all of them.
+	auto shortest_path_oracle = make_counted_shortest_path_oracle(network);
+
 	for (const auto& p : passengers) {
 		auto p_indent = dout(DL::WC_D2).indentWithTitle([&](auto&& out){ out << "Passenger " << p.getBaseName(); });
 		auto next_iteration_weights = network.makeEdgeWeightMapCopy();
@@ -251,11 +447,13 @@ Scheduler2::EdgeWantedCapacities Scheduler2::compute_edge_wanted_capacities() {
 				return iteration_weights[network.getEdgeIndex(edge_desc)];
 			};
 			auto weight_map = boost::make_function_property_map<TrackNetwork::EdgeID, double>(iteration_weights_f);
-			auto route_for_p = ::util::get_shortest_route(
-				p,
-				network,
-				weight_map
-			);
+			auto route_for_p = [&]() {
+				if (iteration_num == 1) {
+					return get_counted_route(shortest_path_oracle, p.getEntryID(), p.getExitID());
+				} else {
+					return get_counted_route(shortest_path_oracle, p.getEntryID(), p.getExitID(), weight_map);
+				}
+			}();
 			::util::print_route(route_for_p,network,dout(DL::WC_D2));
 			dout(DL::WC_D2) << '\n';
 			{
@@ -458,13 +656,10 @@ Schedule Scheduler3::do_schedule() {
 
 Scheduler3::TrainDataList Scheduler3::make_one_train_per_passenger() const {
 	TrainDataList train_data;
+	auto shortest_path_oracle = make_counted_shortest_path_oracle(network);
 	for (const auto& p : passengers) {
 		train_data.emplace_back(
-			::util::get_shortest_route(
-				p.getEntryID(),
-				p.getExitID(),
-				network
-			),
+			get_counted_route(shortest_path_oracle, p.getEntryID(), p.getExitID()),
 			TrainData::add_endpoint_src_and_dest()
 		);
 	}
@@ -475,18 +670,26 @@ Scheduler3::TrainDataList Scheduler3::coalesce_trains(TrainDataList&& train_data
 
 	size_t old_size = train_data.size();
 	int iter_num = 1;
+
+	// kept up to date by each step, instead of being remade for each one
+	VertexOccurrenceIndex vertex_occurrences(train_data, network);
+
 	while (true) {
 		auto iter_indent = dout(DL::TR_D2).indentWithTitle([&](auto&& str) {
 			str << "Coalescing Iteration " << iter_num;
 		});
+		metrics::count(metrics::Counter::COALESCING_PASSES);
+		const auto size_before_pass = train_data.size();
 
-		train_data = schstep_remove_redundant_trains(std::move(train_data));
+		train_data = schstep_remove_redundant_trains(std::move(train_data), vertex_occurrences);
 
-		train_data = schstep_combine_trains(std::move(train_data));
+		train_data = schstep_combine_trains(std::move(train_data), vertex_occurrences);
 
-		train_data = schstep_remove_unneeded_trains(std::move(train_data));
+		train_data = schstep_remove_unneeded_trains(std::move(train_data), vertex_occurrences);
 
-		train_data = schstep_spurify(std::move(train_data));
+		train_data = schstep_spurify(std::move(train_data), vertex_occurrences);
+
+		metrics::count(metrics::Counter::TRAINS_MERGED, size_before_pass - train_data.size());
 
 		if (train_data.size() <= max_trains_at_a_time || train_data.size() == old_size || iter_num == 10) {
 			break;
@@ -500,18 +703,38 @@ Scheduler3::TrainDataList Scheduler3::coalesce_trains(TrainDataList&& train_data
 	return std::move(train_data);
 }
 
-Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataList&& train_data) const {
+Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const {
 	// the train that will take over the duties of the i'th train.
 	// not sure we need to do this every time...
 	std::vector<size_t> train_is_rudundant_with(train_data.size(), NO_TRAIN);
 
+	std::vector<size_t> comp_train_candidates;
+
 	for (size_t train_i = 0; train_i != train_data.size(); ++train_i) {
 		if (train_is_rudundant_with[train_i] != NO_TRAIN) { continue; }
-		auto& train = train_data[train_i].get_train();
+		const auto& train = train_data[train_i].get_train();
+
+		// only trains that pass through train's first node, or that start somewhere
+		// on train, can overlap with it. Visit them in the same order as a full scan would.
+		comp_train_candidates.clear();
+		for (const auto& occurrence : vertex_occurrences.getOccurrencesOf(train.front())) {
+			if (occurrence.itrain > train_i) { comp_train_candidates.push_back(occurrence.itrain); }
+		}
+		for (const auto& vertex : train) {
+			for (const auto& comp_train_i : vertex_occurrences.getTrainsStartingAt(vertex)) {
+				if (comp_train_i > train_i) { comp_train_candidates.push_back(comp_train_i); }
+			}
+		}
+		std::sort(comp_train_candidates.begin(), comp_train_candidates.end());
+		comp_train_candidates.erase(
+			std::unique(comp_train_candidates.begin(), comp_train_candidates.end()),
+			comp_train_candidates.end()
+		);
 
-		for (size_t comp_train_i = train_i + 1; comp_train_i != train_data.size(); ++comp_train_i) {
+		for (const auto& comp_train_i : comp_train_candidates) {
 			if (train_is_rudundant_with[comp_train_i] != NO_TRAIN) { continue; }
-			auto& comp_train = train_data[comp_train_i].get_train();
+			const auto& comp_train = train_data[comp_train_i].get_train();
+			const auto& overlaps = vertex_occurrences.getOverlaps(train_i, comp_train_i, train_data);
 
 			// TODO: this DOES NOT handle repeated vertices...
 			// TODO: keep track of how many (and what wanted capacity) routes get combinded
@@ -520,45 +743,44 @@ Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataL
 			// IDEA: A "move" is a swap of edges between train_data, or a re-route.
 			//       A timing analysis is done after.
 
-			// the location of the train's first node in comp_train
-			auto comp_first_match = std::find(
-				comp_train.begin(), comp_train.end(), train.front()
-			);
+			// the location of the train's first node in comp_train. Overlaps are in
+			// (location in train, location in comp_train) order, so it's the first one
+			const auto comp_first_match = std::find_if(overlaps.begin(), overlaps.end(), [](const auto& overlap) {
+				return overlap.my_start == 0;
+			});
 
 			// the location of the comp_train's first node in train
-			auto first_match = std::find(
-				train.begin(), train.end(), comp_train.front()
-			);
+			const auto first_match = std::find_if(overlaps.begin(), overlaps.end(), [](const auto& overlap) {
+				return overlap.other_start == 0;
+			});
 
-			if (first_match == train.end() && comp_first_match == comp_train.end()) {
+			// where the two start going together. If both first nodes overlap, they
+			// only do if both trains start at the same vertex
+			auto start_of_overlap = overlaps.end();
+			if (first_match == overlaps.end() && comp_first_match == overlaps.end()) {
 				// neither path overlaps with the other
 				continue;
+			} else if (first_match == overlaps.end()) {
+				start_of_overlap = comp_first_match;
+			} else if (comp_first_match == overlaps.end() || first_match == comp_first_match) {
+				start_of_overlap = first_match;
 			} else {
-				// exactly one train first node overlaps,
-				// so reset the other to it's beginning, so mismatch will
-				// start at where they overlap
-				if (first_match == train.end()) {
-					first_match = train.begin();
-				}
-
-				if (comp_first_match == comp_train.end()) {
-					comp_first_match = comp_train.begin();
-				}
+				// paths diverge straight away
+				continue;
 			}
 
-			auto mismatch_results = std::mismatch(
-				first_match, train.end(),
-				comp_first_match, comp_train.end()
-			);
-			bool      reached_end = mismatch_results.first  == train.end();
-			bool comp_reached_end = mismatch_results.second == comp_train.end();
+			// exactly one train first node overlaps, or they start at the same place
+			const bool      reached_end = (size_t)start_of_overlap->my_end    == train.size();
+			const bool comp_reached_end = (size_t)start_of_overlap->other_end == comp_train.size();
+			const bool      starts_at_beginning = start_of_overlap->my_start    == 0;
+			const bool comp_starts_at_beginning = start_of_overlap->other_start == 0;
 
 			size_t redundant_train = -1;
 			if (!reached_end && !comp_reached_end) {
 				// paths diverged, so add for consideration for extension (TODO)
 				continue;
 			} else if (!reached_end && comp_reached_end) {
-				if (first_match == train.begin()) {
+				if (starts_at_beginning) {
 					// extend comp train? maybe. So, add to consideration. (TODO)
 					continue;
 				} else {
@@ -568,7 +790,7 @@ Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataL
 					redundant_train = comp_train_i;
 				}
 			} else if (reached_end && !comp_reached_end) {
-				if (comp_first_match == comp_train.begin()) {
+				if (comp_starts_at_beginning) {
 					// extend train? maybe. So, add to consideration. (TODO)
 					continue;
 				} else {
@@ -580,9 +802,9 @@ Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataL
 			} else {
 				// both end on the same vertex, so remove the shorter one.
 				// (the one that could have it's start vertex found in the other)
-				if (first_match == train.begin()) {
+				if (starts_at_beginning) {
 					redundant_train = train_i;
-				} else if (comp_first_match == comp_train.begin()) {
+				} else if (comp_starts_at_beginning) {
 					redundant_train = comp_train_i;
 				} else {
 					::util::print_and_throw<std::runtime_error>([&](auto&& err) { err << "don't handle convergence case\n"; });
@@ -608,14 +830,14 @@ Scheduler3::TrainDataList Scheduler3::schstep_remove_redundant_trains(TrainDataL
 		train_data[repalcemnt_train].add_src_dest_pairs_of(train_data[itrain]);
 	}
 
-	train_data = remove_redundant_trains(std::move(train_data), train_is_rudundant_with);
+	train_data = remove_redundant_trains(std::move(train_data), train_is_rudundant_with, vertex_occurrences);
 
 	dump_trains_to_dout(train_data, "Trains After Basic Redundancy Removal", DL::TR_D2);
 
 	return train_data;
 }
 
-Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& train_data) const {
+Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const {
 	struct CombineData { // means combine with itrain starting at my index where_in_me_to_start_combining
 		size_t itrain;
 		ptrdiff_t where_in_me_to_start_combining;
@@ -623,38 +845,48 @@ Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& tra
 
 	auto indent = dout(DL::TR_D2).indentWithTitle("Basic Combining");
 
-	std::vector<std::vector<CombineData>> trains_that_could_combine_list;
-
 	auto train_index_range = ::util::xrange_forward_pe<size_t>(0,train_data.size());
 
-	for (const auto& itrain : train_index_range) {
-		trains_that_could_combine_list.emplace_back();
-		const auto& this_train_route = train_data[itrain].get_train();
+	std::vector<std::vector<CombineData>> trains_that_could_combine_list(train_data.size());
 
-		for (const auto& iother_train : train_index_range) {
-			if (iother_train == itrain) {
-				continue;
+
+	// check if another train overlaps with the end of this one. It has to start
+	// somewhere on this one to do that.
+	std::vector<std::vector<size_t>> trains_starting_on_list(train_data.size());
+	::util::parallel_for_index(train_data.size(), num_threads(), [&](size_t itrain) {
+		auto& trains_starting_on = trains_starting_on_list[itrain];
+		for (const auto& vertex : train_data[itrain].get_train()) {
+			for (const auto& iother_train : vertex_occurrences.getTrainsStartingAt(vertex)) {
+				if (iother_train != itrain) {
+					trains_starting_on.push_back(iother_train);
+				}
 			}
+		}
+		std::sort(trains_starting_on.begin(), trains_starting_on.end());
+		trains_starting_on.erase(std::unique(trains_starting_on.begin(), trains_starting_on.end()), trains_starting_on.end());
+	});
 
-			const auto& other_train_route = train_data[iother_train].get_train();
+	vertex_occurrences.compareTrains(trains_starting_on_list, train_data, num_threads());
 
-			// check if the other train overlaps with the end of this one
-			// we only want forward overlaps. If we want backward ones, they
-			// can be more efficiently derived from these, than computed directly
-			for (const auto& it : iterate_as_iterators(this_train_route)) {
-				const auto mismatch_results = std::mismatch(
-					other_train_route.begin(), other_train_route.end(),
-					it, this_train_route.end()
-				);
+	for (const auto& itrain : train_index_range) {
+		auto& trains_that_could_combine = trains_that_could_combine_list[itrain];
+		const auto& this_train_route = train_data[itrain].get_train();
 
-				if (mismatch_results.second == this_train_route.end()) {
-					trains_that_could_combine_list.back().emplace_back(
-						CombineData{ iother_train, distance(begin(this_train_route), it) }
+		// we only want forward overlaps. If we want backward ones, they
+		// can be more efficiently derived from these, than computed directly
+		for (const auto& iother_train : trains_starting_on_list[itrain]) {
+			for (const auto& overlap : vertex_occurrences.getComparedOverlaps(itrain, iother_train)) {
+				if (overlap.other_start == 0 && (size_t)overlap.my_end == this_train_route.size()) {
+					trains_that_could_combine.emplace_back(
+						CombineData{ iother_train, overlap.my_start }
 					);
-					dout(DL::TR_D3) << itrain << " can combine with " << iother_train << " starting at " << trains_that_could_combine_list.back().back().where_in_me_to_start_combining << '\n';
 				}
 			}
 		}
+
+		for (const auto& combine_data : trains_that_could_combine) {
+			dout(DL::TR_D3) << itrain << " can combine with " << combine_data.itrain << " starting at " << combine_data.where_in_me_to_start_combining << '\n';
+		}
 	}
 
 	if (trains_that_could_combine_list.size() != train_data.size()) {
@@ -759,6 +991,15 @@ Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& tra
 		}
 		dout(DL::TR_D3) << '\n';
 
+		// the new train takes the place of it's first component, so the rest go away
+		for (size_t icomponent = 1; icomponent < new_train_components.size(); ++icomponent) {
+			const auto& itrain = new_train_components[icomponent];
+			vertex_occurrences.removeTrain(itrain, train_data[itrain].get_train());
+		}
+		if (new_path != train_data[new_train_components.front()].get_train()) {
+			vertex_occurrences.replaceRoute(new_train_components.front(), train_data[new_train_components.front()].get_train(), new_path);
+		}
+
 		new_train_data.emplace_back(std::move(new_path), TrainData::dont_add_endpoint_src_and_dest());
 
 		for (const auto& itrain : new_train_components) {
@@ -767,6 +1008,7 @@ Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& tra
 	}
 
 	train_data = std::move(new_train_data);
+	vertex_occurrences.renumber();
 
 	// train_data = remove_redundant_trains(std::move(train_data), train_is_rudundant_with);
 
@@ -775,7 +1017,7 @@ Scheduler3::TrainDataList Scheduler3::schstep_combine_trains(TrainDataList&& tra
 	return std::move(train_data);
 }
 
-Scheduler3::TrainDataList Scheduler3::schstep_remove_unneeded_trains(TrainDataList&& train_data) const {
+Scheduler3::TrainDataList Scheduler3::schstep_remove_unneeded_trains(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const {
 	std::vector<size_t> train_is_rudundant_with(train_data.size(), NO_TRAIN);
 
 	/* pick a route (for each route?), see which (src,dest)s can't make it without this route
@@ -793,66 +1035,108 @@ Scheduler3::TrainDataList Scheduler3::schstep_remove_unneeded_trains(TrainDataLi
 		TrackNetwork::NodeID dest;
 	};
 
-	//TODO: this is rather trivially parallelizable
-
-	::algo::RouteTroughScheduleCacheHandle rts_cache_handle;
-
-	for (size_t itrain = 0; itrain != train_data.size(); ++itrain) {
+	// does anyone need this train to get where they are going?
+	const auto is_needed = [&](size_t itrain) {
 		auto path_testing_indent = dout(DL::TR_D1).indentWithTitle([&](auto&& s) {
 			s << "Testing train #" << itrain;
 		});
 
 		std::vector<SrcDestPair> needs_this_train;
 
-		// remove this train for testing
-		TrainData this_train_data;
-		std::swap(this_train_data, train_data[itrain]);
+		// Routing through a schedule of all the other trains would find a route exactly
+		// when the dest can be got to by riding them: they all repeat forever, so from
+		// anywhere a train stops, everywhere it goes after that can be got to. So, search
+		// that with the index, instead of making a Schedule and Timetable without this train.
+		std::vector<char> is_reached(num_vertices(network.g()), false);
+		std::vector<TrackNetwork::NodeID> reached;
+		std::unordered_map<size_t, ptrdiff_t> earliest_boarding_of_train;
 
+		const auto& this_train_data = train_data[itrain];
 		for (const auto& src : this_train_data.get_srces()) {
 			auto src_dest_indent = dout(DL::TR_D2).indentWithTitle([&](auto&& s) {
 				s << "Test Paths from " << src;
 			});
+
+			for (const auto& vertex : reached) {
+				is_reached[vertex] = false;
+			}
+			reached.assign(1, src);
+			is_reached[src] = true;
+			earliest_boarding_of_train.clear();
+
+			for (size_t ireached = 0; ireached != reached.size(); ++ireached) {
+				for (const auto& occurrence : vertex_occurrences.getOccurrencesOf(reached[ireached])) {
+					if (occurrence.itrain == itrain) {
+						continue; // leave this train out for testing
+					}
+
+					// if it has already been boarded at or before here, everything after has been looked at
+					const auto& other_train_route = train_data[occurrence.itrain].get_train();
+					auto scan_until = (ptrdiff_t)other_train_route.size();
+					const auto boarding_find_results = earliest_boarding_of_train.find(occurrence.itrain);
+					if (boarding_find_results == earliest_boarding_of_train.end()) {
+						earliest_boarding_of_train.emplace(occurrence.itrain, occurrence.position);
+					} else if (boarding_find_results->second <= occurrence.position) {
+						continue;
+					} else {
+						scan_until = boarding_find_results->second;
+						boarding_find_results->second = occurrence.position;
+					}
+
+					for (auto position = occurrence.position + 1; position < scan_until; ++position) {
+						const auto& next_vertex = other_train_route[position];
+						if (!is_reached[next_vertex]) {
+							is_reached[next_vertex] = true;
+							reached.push_back(next_vertex);
+						}
+					}
+				}
+			}
+
 			for (const auto& dest : this_train_data.get_dests_of(src)) {
-				auto src_dest_indent = dout(DL::TR_D3).indentWithTitle([&](auto&& s) {
-					s << "Test Path " << src << " -> " << dest;
-				});
-
-				PassengerRoutes::RouteType route_found;
-
-				std::tie(route_found, rts_cache_handle) = ::algo::route_through_schedule(
-					network,
-					make_a_schedule__all_start_zero("no-need schedule", train_data, network),
-					0, // need to specify some kind of start time
-					src, dest,
-					std::move(rts_cache_handle)
-				);
+				dout(DL::TR_D3) << "Test Path " << src << " -> " << dest << (is_reached[dest] ? ": found\n" : ": not found\n");
 
-				if (route_found.empty()) {
+				if (!is_reached[dest]) {
 					needs_this_train.emplace_back(SrcDestPair{src, dest});
 				}
 			}
 		}
 
 		if (needs_this_train.size() == 0) {
-			train_is_rudundant_with[itrain] = -2; // anything but NO_TRAIN...
 			dout(DL::TR_D1) << "no one NEEDS train " << itrain << '\n';
-			break; // only one train can be safely removed at a time
+			return false;
 		} else {
 			dout(DL::TR_D1) << "someone needs train " << itrain << '\n';
+			return true;
 		}
+	};
+
+	// test a batch of trains at a time, one per thread, and take the first unneeded
+	// one in index order, just as testing them one after another would.
+	const auto batch_size = num_threads();
+	for (size_t batch_start = 0; batch_start < train_data.size(); batch_start += batch_size) {
+		const auto batch_end = std::min(batch_start + batch_size, train_data.size());
 
-		// put this train back
-		train_data[itrain] = std::move(this_train_data);
+		std::vector<char> train_is_needed(batch_end - batch_start);
+		::util::parallel_for_index(train_is_needed.size(), batch_size, [&](size_t ibatch) {
+			train_is_needed[ibatch] = is_needed(batch_start + ibatch);
+		});
+
+		const auto first_unneeded = std::find(train_is_needed.begin(), train_is_needed.end(), false);
+		if (first_unneeded != train_is_needed.end()) {
+			train_is_rudundant_with[batch_start + distance(train_is_needed.begin(), first_unneeded)] = -2; // anything but NO_TRAIN...
+			break; // only one train can be safely removed at a time
+		}
 	}
 
-	train_data = remove_redundant_trains(std::move(train_data), train_is_rudundant_with);
+	train_data = remove_redundant_trains(std::move(train_data), train_is_rudundant_with, vertex_occurrences);
 
 	dump_trains_to_dout(train_data, "Trains After No-Need-Removal", DL::TR_D2);
 
 	return train_data;
 }
 
-Scheduler3::TrainDataList Scheduler3::schstep_spurify(TrainDataList&& train_data) const {
+Scheduler3::TrainDataList Scheduler3::schstep_spurify(TrainDataList&& train_data, VertexOccurrenceIndex& vertex_occurrences) const {
 	// decide which trains & how to make into suprs off other trains.
 	// what about when a main line overlaps with the middle of a route?
 	struct IntersectionData {
@@ -862,43 +1146,42 @@ Scheduler3::TrainDataList Scheduler3::schstep_spurify(TrainDataList&& train_data
 		ptrdiff_t my_intersection_with_iothertrain_end;
 	};
 
-	std::vector<std::vector<IntersectionData>> intersection_data_list;
+	std::vector<std::vector<IntersectionData>> intersection_data_list(train_data.size());
 
 	auto index_range = [](auto& c) { return ::util::xrange_forward_pe<size_t>(0,c.size()); };
 
-	for (const auto& itrain : index_range(train_data)) {
-		intersection_data_list.emplace_back();
-		const auto& this_train_route = train_data[itrain].get_train();
 
-		for (const auto& iothertrain : index_range(train_data)) {
-			if (iothertrain == itrain) {
-				continue;
+	// only overlap that goes to the end of a train is used below, so only trains
+	// that go through its last vertex have to be looked at
+	std::vector<std::vector<size_t>> trains_through_end_list(train_data.size());
+	::util::parallel_for_index(train_data.size(), num_threads(), [&](size_t itrain) {
+		auto& trains_through_end = trains_through_end_list[itrain];
+		for (const auto& occurrence : vertex_occurrences.getOccurrencesOf(train_data[itrain].get_train().back())) {
+			if (occurrence.itrain != itrain) {
+				trains_through_end.push_back(occurrence.itrain);
 			}
-
-			const auto& other_train_route = train_data[iothertrain].get_train();
-
-			for (const auto& it : iterate_as_iterators(this_train_route)) {
-				for (const auto& iother_it : iterate_as_iterators(other_train_route)) {
-					const auto mismatch_results = std::mismatch(
-						iother_it, other_train_route.end(),
-						it, this_train_route.end()
-					);
-
-					// if there was any sort of match
-					if (mismatch_results.second != it) {
-						intersection_data_list.back().emplace_back(
-							IntersectionData{
-								iothertrain,
-								distance(begin(other_train_route), mismatch_results.first),
-								distance(begin(this_train_route), it),
-								distance(begin(this_train_route), mismatch_results.second)
-							}
-						);
+		}
+		trains_through_end.erase(std::unique(trains_through_end.begin(), trains_through_end.end()), trains_through_end.end());
+	});
+
+	vertex_occurrences.compareTrains(trains_through_end_list, train_data, num_threads());
+
+	// copied, as the trains get changed while examining
+	::util::parallel_for_index(train_data.size(), num_threads(), [&](size_t itrain) {
+		auto& intersection_data = intersection_data_list[itrain];
+		for (const auto& iothertrain : trains_through_end_list[itrain]) {
+			for (const auto& overlap : vertex_occurrences.getComparedOverlaps(itrain, iothertrain)) {
+				intersection_data.emplace_back(
+					IntersectionData{
+						iothertrain,
+						overlap.other_end,
+						overlap.my_start,
+						overlap.my_end
 					}
-				}
+				);
 			}
 		}
-	}
+	});
 
 	{ auto eindent = dout(DL::TR_D1).indentWithTitle([&](auto&& s){ s << "Examining Intersecton Data"; });
 	for (const auto& itrain : index_range(train_data)) {
@@ -933,6 +1216,7 @@ Scheduler3::TrainDataList Scheduler3::schstep_spurify(TrainDataList&& train_data
 			dout(DL::TR_D1) << "removing end and relying on train #" << int_data.iothertrain << '\n';
 			// truncate & replace
 			// VertexList inew_route;
+			vertex_occurrences.truncateRoute(itrain, iroute, int_data.my_intersection_with_iothertrain_start + 1);
 			iroute.erase(
 				begin(iroute) + int_data.my_intersection_with_iothertrain_start + 1,
 				end(iroute)
@@ -951,12 +1235,20 @@ Scheduler3::TrainDataList Scheduler3::schstep_spurify(TrainDataList&& train_data
 
 Scheduler3::TrainDataList remove_redundant_trains(
 	Scheduler3::TrainDataList&& train_data,
-	const std::vector<size_t>& train_is_rudundant_with
+	const std::vector<size_t>& train_is_rudundant_with,
+	Scheduler3::VertexOccurrenceIndex& vertex_occurrences
 ) {
 	auto train_is_rudundant_at_this_index = [&](const auto& index) {
 		return train_is_rudundant_with[index] != NO_TRAIN;
 	};
 
+	for (size_t itrain = 0; itrain != train_data.size(); ++itrain) {
+		if (train_is_rudundant_at_this_index(itrain)) {
+			vertex_occurrences.removeTrain(itrain, train_data[itrain].get_train());
+		}
+	}
+	vertex_occurrences.renumber();
+
 	train_data.erase(
 		::util::remove_by_index(
 			train_data.begin(), train_data.end(),
@@ -989,6 +1281,238 @@ void Scheduler3::dump_trains_to_dout(
 	}
 }
 
+size_t Scheduler3::num_threads() const {
+	if (dout(DL::TR_D1).enabled() || dout(DL::PR_D1).enabled()) {
+		return 1;
+	} else {
+		return ::util::default_num_threads();
+	}
+}
+
+Scheduler3::VertexOccurrenceIndex::VertexOccurrenceIndex(const TrainDataList& train_data, const TrackNetwork& network)
+	: occurrences(num_vertices(network.g()))
+	, slots_starting_at(num_vertices(network.g()))
+	, slot_of_train(train_data.size())
+	, train_of_slot(train_data.size())
+	, overlaps_of_slot(train_data.size())
+{
+	for (size_t itrain = 0; itrain != train_data.size(); ++itrain) {
+		slot_of_train[itrain] = itrain;
+		train_of_slot[itrain] = itrain;
+		addRoute(itrain, train_data[itrain].get_train());
+	}
+}
+
+void Scheduler3::VertexOccurrenceIndex::removeTrain(size_t itrain, const VertexList& route) {
+	const auto slot = slot_of_train.at(itrain);
+	markOverlapsDirty(slot);
+	removeRoute(slot, route);
+	train_of_slot[slot] = NO_TRAIN;
+}
+
+void Scheduler3::VertexOccurrenceIndex::replaceRoute(size_t itrain, const VertexList& old_route, const VertexList& new_route) {
+	const auto slot = slot_of_train.at(itrain);
+	markOverlapsDirty(slot);
+	removeRoute(slot, old_route);
+	addRoute(slot, new_route);
+}
+
+void Scheduler3::VertexOccurrenceIndex::truncateRoute(size_t itrain, const VertexList& route, size_t new_length) {
+	const auto slot = slot_of_train.at(itrain);
+	markOverlapsDirty(slot);
+	if (new_length == 0 && route.empty() == false) {
+		auto& starting_here = slots_starting_at[route.front()];
+		starting_here.erase(std::lower_bound(starting_here.begin(), starting_here.end(), slot));
+	}
+	for (size_t position = new_length; position < route.size(); ++position) {
+		auto& list = occurrences[route[position]];
+		list.erase(std::lower_bound(list.begin(), list.end(), SlotOccurrence{ slot, (ptrdiff_t)position }));
+	}
+}
+
+void Scheduler3::VertexOccurrenceIndex::renumber() {
+	slot_of_train.clear();
+	for (size_t slot = 0; slot != train_of_slot.size(); ++slot) {
+		if (train_of_slot[slot] != NO_TRAIN) {
+			train_of_slot[slot] = slot_of_train.size();
+			slot_of_train.push_back(slot);
+		}
+	}
+}
+
+const Scheduler3::VertexOccurrenceIndex::OverlapList& Scheduler3::VertexOccurrenceIndex::getOverlaps(size_t itrain, size_t iother, const TrainDataList& train_data) {
+	const auto slot = slot_of_train.at(itrain);
+	const auto other_slot = slot_of_train.at(iother);
+
+	const auto find_results = overlaps_of_slot[slot].find(other_slot);
+	if (find_results != overlaps_of_slot[slot].end()) {
+		metrics::count(metrics::Counter::COALESCING_PAIRS_REUSED);
+		return find_results->second;
+	}
+
+	metrics::count(metrics::Counter::COALESCING_PAIR_EVALUATIONS);
+	thread_local RoutePositions other_train_positions;
+	other_train_positions.setRoute(train_data[iother].get_train(), occurrences.size());
+	auto overlaps = other_train_positions.compareWith(train_data[itrain].get_train());
+	overlaps_of_slot[other_slot][slot] = reverseOverlaps(overlaps);
+	return overlaps_of_slot[slot][other_slot] = std::move(overlaps);
+}
+
+void Scheduler3::VertexOccurrenceIndex::compareTrains(const std::vector<std::vector<size_t>>& trains_to_compare_with, const TrainDataList& train_data, size_t num_threads) {
+	// the trains each one has to be compared with. If both want to be compared with
+	// each other, the lower one does it.
+	std::vector<std::vector<size_t>> trains_to_compare_now(trains_to_compare_with.size());
+	std::atomic<uint64_t> num_reused(0);
+	::util::parallel_for_index(trains_to_compare_with.size(), num_threads, [&](size_t itrain) {
+		const auto& overlaps = overlaps_of_slot[slot_of_train.at(itrain)];
+		for (const auto& iother : trains_to_compare_with[itrain]) {
+			if (overlaps.find(slot_of_train.at(iother)) != overlaps.end()) {
+				num_reused += 1;
+			} else if (itrain < iother || !std::binary_search(trains_to_compare_with[iother].begin(), trains_to_compare_with[iother].end(), itrain)) {
+				trains_to_compare_now[itrain].push_back(iother);
+			}
+		}
+	});
+
+	// the other train's side of each, to be kept once all are done
+	std::vector<std::vector<OverlapList>> reversed_results(trains_to_compare_now.size());
+	::util::parallel_for_index(trains_to_compare_now.size(), num_threads, [&](size_t itrain) {
+		if (trains_to_compare_now[itrain].empty()) {
+			return;
+		}
+
+		thread_local RoutePositions this_train_positions;
+		this_train_positions.setRoute(train_data[itrain].get_train(), occurrences.size());
+
+		auto& overlaps = overlaps_of_slot[slot_of_train.at(itrain)];
+		overlaps.reserve(overlaps.size() + trains_to_compare_now[itrain].size());
+		for (const auto& iother : trains_to_compare_now[itrain]) {
+			reversed_results[itrain].push_back(this_train_positions.compareWith(train_data[iother].get_train()));
+			overlaps[slot_of_train.at(iother)] = reverseOverlaps(reversed_results[itrain].back());
+		}
+	});
+
+	// each thread only touches its own train's overlaps
+	std::vector<std::vector<std::pair<size_t, size_t>>> results_for_train(trains_to_compare_now.size());
+	for (size_t itrain = 0; itrain != trains_to_compare_now.size(); ++itrain) {
+		for (size_t iresult = 0; iresult != trains_to_compare_now[itrain].size(); ++iresult) {
+			results_for_train[trains_to_compare_now[itrain][iresult]].emplace_back(itrain, iresult);
+		}
+	}
+	uint64_t num_evaluations = 0;
+	for (const auto& results : results_for_train) {
+		num_evaluations += results.size();
+	}
+	::util::parallel_for_index(results_for_train.size(), num_threads, [&](size_t iother) {
+		auto& overlaps = overlaps_of_slot[slot_of_train.at(iother)];
+		overlaps.reserve(overlaps.size() + results_for_train[iother].size());
+		for (const auto& itrain_and_iresult : results_for_train[iother]) {
+			overlaps[slot_of_train.at(itrain_and_iresult.first)] = std::move(reversed_results[itrain_and_iresult.first][itrain_and_iresult.second]);
+		}
+	});
+
+	metrics::count(metrics::Counter::COALESCING_PAIR_EVALUATIONS, num_evaluations);
+	metrics::count(metrics::Counter::COALESCING_PAIRS_REUSED, num_reused);
+}
+
+void Scheduler3::VertexOccurrenceIndex::RoutePositions::setRoute(const VertexList& new_route, size_t num_vertices) {
+	route = &new_route;
+	stamp += 1;
+	stamp_of_vertex.resize(num_vertices, 0);
+	first_position_of_vertex.resize(num_vertices);
+	next_position_of_same_vertex.assign(new_route.size(), -1);
+	for (auto position = (ptrdiff_t)new_route.size() - 1; position >= 0; --position) {
+		const auto& vertex = new_route[position];
+		if (stamp_of_vertex[vertex] == stamp) {
+			next_position_of_same_vertex[position] = first_position_of_vertex[vertex];
+		}
+		stamp_of_vertex[vertex] = stamp;
+		first_position_of_vertex[vertex] = position;
+	}
+}
+
+Scheduler3::VertexOccurrenceIndex::OverlapList Scheduler3::VertexOccurrenceIndex::RoutePositions::compareWith(const VertexList& this_train_route) const {
+	OverlapList overlaps;
+	const auto& other_train_route = *route;
+
+	// any match starts with a vertex in common
+	for (const auto& it : iterate_as_iterators(this_train_route)) {
+		if (stamp_of_vertex[*it] != stamp) {
+			continue;
+		}
+		for (
+			auto other_position = first_position_of_vertex[*it];
+			other_position != -1;
+			other_position = next_position_of_same_vertex[other_position]
+		) {
+			// already part of the overlap that started at the vertices before these
+			if (it != begin(this_train_route) && other_position != 0 && *prev(it) == other_train_route[other_position - 1]) {
+				continue;
+			}
+
+			const auto mismatch_results = std::mismatch(
+				begin(other_train_route) + other_position, other_train_route.end(),
+				it, this_train_route.end()
+			);
+
+			overlaps.emplace_back(Overlap{
+				distance(begin(this_train_route), it),
+				other_position,
+				distance(begin(this_train_route), mismatch_results.second),
+				distance(begin(other_train_route), mismatch_results.first),
+			});
+		}
+	}
+
+	return overlaps;
+}
+
+Scheduler3::VertexOccurrenceIndex::OverlapList Scheduler3::VertexOccurrenceIndex::reverseOverlaps(const OverlapList& overlaps) {
+	OverlapList reversed;
+	for (const auto& overlap : overlaps) {
+		reversed.emplace_back(Overlap{ overlap.other_start, overlap.my_start, overlap.other_end, overlap.my_end });
+	}
+	std::sort(reversed.begin(), reversed.end(), [](const auto& lhs, const auto& rhs) {
+		return std::tie(lhs.my_start, lhs.other_start) < std::tie(rhs.my_start, rhs.other_start);
+	});
+	return reversed;
+}
+
+void Scheduler3::VertexOccurrenceIndex::markOverlapsDirty(size_t slot) {
+	auto& overlaps = overlaps_of_slot[slot];
+	for (const auto& other_slot_and_overlaps : overlaps) {
+		overlaps_of_slot[other_slot_and_overlaps.first].erase(slot);
+	}
+	overlaps.clear();
+}
+
+void Scheduler3::VertexOccurrenceIndex::addRoute(size_t slot, const VertexList& route) {
+	if (route.empty()) {
+		return;
+	}
+	auto& starting_here = slots_starting_at[route.front()];
+	starting_here.insert(std::upper_bound(starting_here.begin(), starting_here.end(), slot), slot);
+	for (const auto& it : iterate_as_iterators(route)) {
+		auto& list = occurrences[*it];
+		const SlotOccurrence occurrence{ slot, distance(begin(route), it) };
+		list.insert(std::upper_bound(list.begin(), list.end(), occurrence), occurrence);
+	}
+}
+
+void Scheduler3::VertexOccurrenceIndex::removeRoute(size_t slot, const VertexList& route) {
+	if (route.empty()) {
+		return;
+	}
+	auto& starting_here = slots_starting_at[route.front()];
+	starting_here.erase(std::lower_bound(starting_here.begin(), starting_here.end(), slot));
+	for (const auto& vertex : route) {
+		// a vertex can be in a route more than once, so take all of this slot's occurrences
+		auto& list = occurrences[vertex];
+		const auto range = std::equal_range(list.begin(), list.end(), slot, SlotLess());
+		list.erase(range.first, range.second);
+	}
+}
+
 void Scheduler3::TrainData::add_src_dest_pairs_of(const TrainData& td) {
 	for (const auto& src : td.get_srces()) {
 		for (const auto& dest : td.get_dests_of(src)) {
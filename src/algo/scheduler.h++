@@ -13,6 +13,7 @@ public:
 	Schedule()
 		: name("")
 		, train_routes()
+		, serial_number(makeSerialNumber())
 	{ }
 
 	Schedule(
@@ -21,6 +22,7 @@ public:
 	)
 		: name(name)
 		, train_routes(std::move(train_routes))
+		, serial_number(makeSerialNumber())
 	{ }
 
 	Schedule(const Schedule&) = delete;
@@ -31,6 +33,13 @@ public:
 	// getters
 	const std::string& getName() const { return name; }
 
+	/**
+	 * Unique to each constructed Schedule, and follows the contents on move.
+	 * For use by things that cache data derived from a Schedule, as addresses
+	 * get reused.
+	 */
+	uint64_t getSerialNumber() const { return serial_number; }
+
 	TrainRoute& getTrainRoute(RouteID id) { return train_routes.at(id.getValue()); }
 	const TrainRoute& getTrainRoute(RouteID id) const { return train_routes.at(id.getValue()); }
 	const auto& getTrainRoutes() const { return train_routes; }
@@ -46,8 +55,11 @@ public:
 		return ::util::with_my_hash_t<std::unordered_map,TrainID,MAPPED_TYPE>(std::forward<ARGS>(args)...);
 	}
 private:
+	static uint64_t makeSerialNumber();
+
 	std::string name;
 	std::vector<TrainRoute> train_routes;
+	uint64_t serial_number;
 };
 
 template<typename MAPPED_TYPE>
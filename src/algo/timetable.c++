@@ -0,0 +1,119 @@
+#include "timetable.h++"
+
+#include <util/logging.h++>
+
+#include <algorithm>
+#include <numeric>
+
+namespace algo {
+
+const Timetable::StopIndex Timetable::INVALID_STOP = -1;
+
+Timetable::Timetable(const Schedule& sch, const TrackNetwork& tn)
+	: schedule_serial_number(sch.getSerialNumber())
+	, route_stops_begin()
+	, route_start_offsets_begin()
+	, route_repeat_times()
+	, stop_routes()
+	, stop_vertices()
+	, stop_arrival_offsets()
+	, start_offsets()
+	, sorted_start_offsets()
+	, sorted_start_offset_original_indices()
+	, vertex_stops_begin(num_vertices(tn.g()) + 1, 0)
+	, vertex_stops()
+{
+	for (const auto& train_route : sch.getTrainRoutes()) {
+		route_stops_begin.push_back(stop_vertices.size());
+		route_start_offsets_begin.push_back(sorted_start_offsets.size());
+		route_repeat_times.push_back(train_route.getRepeatTime());
+
+		// accumulate one edge at a time, instead of calling getExpectedTravelTime
+		// for each stop (which would re-sum the whole prefix each time)
+		const auto& path = train_route.getPath();
+		Time arrival_offset = 0;
+		for (auto it = path.begin(); it != path.end(); ++it) {
+			if (it != path.begin()) {
+				arrival_offset += train_route.getExpectedTravelTime(
+					0, ::boost::make_iterator_range(std::prev(it), std::next(it)), tn
+				);
+			}
+			stop_routes.push_back(train_route.getID());
+			stop_vertices.push_back(*it);
+			stop_arrival_offsets.push_back(arrival_offset);
+		}
+
+		const auto& route_start_offsets = train_route.getStartOffsets();
+		std::vector<TrainIndex> order(route_start_offsets.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](const auto& lhs, const auto& rhs) {
+			return route_start_offsets[lhs] < route_start_offsets[rhs];
+		});
+		for (const auto& index : order) {
+			sorted_start_offsets.push_back(route_start_offsets[index]);
+			sorted_start_offset_original_indices.push_back(index);
+		}
+		start_offsets.insert(start_offsets.end(), route_start_offsets.begin(), route_start_offsets.end());
+	}
+	route_stops_begin.push_back(stop_vertices.size());
+	route_start_offsets_begin.push_back(sorted_start_offsets.size());
+
+	// counting sort the stops by vertex
+	for (const auto& v : stop_vertices) {
+		vertex_stops_begin[v + 1] += 1;
+	}
+	std::partial_sum(vertex_stops_begin.begin(), vertex_stops_begin.end(), vertex_stops_begin.begin());
+	vertex_stops.resize(stop_vertices.size());
+	{
+		auto insert_positions = vertex_stops_begin;
+		for (StopIndex stop = 0; stop != stop_vertices.size(); ++stop) {
+			vertex_stops[insert_positions[stop_vertices[stop]]++] = stop;
+		}
+	}
+
+	dout(DL::PR_D2) << "compiled timetable with " << getNumStops() << " stops on " << route_repeat_times.size() << " routes\n";
+}
+
+TrainIndex Timetable::getFirstTrainArrivingAtOrAfter(StopIndex stop, Time t) const {
+	const auto route_index = stop_routes[stop].getValue();
+	const auto offsets_begin = sorted_start_offsets.begin() + route_start_offsets_begin[route_index];
+	const auto offsets_end = sorted_start_offsets.begin() + route_start_offsets_begin[route_index + 1];
+	const auto num_per_repeat = std::distance(offsets_begin, offsets_end);
+	const auto repeat_time = route_repeat_times[route_index];
+
+	if (num_per_repeat == 0 || repeat_time <= 0) {
+		::util::print_and_throw<std::invalid_argument>([&](auto&& err) {
+			err << "route " << stop_routes[stop] << " has no trains, or does not repeat";
+		});
+	}
+
+	// want the first departure at or after this
+	const auto departure_time = t - stop_arrival_offsets[stop];
+
+	// floor division, and trains start at t = 0
+	const Time repeat_number = std::max(
+		0, departure_time / repeat_time - ((departure_time % repeat_time) < 0 ? 1 : 0)
+	);
+	const auto found = std::lower_bound(
+		offsets_begin, offsets_end, departure_time - repeat_number*repeat_time
+	);
+
+	if (found == offsets_end) {
+		return (repeat_number + 1)*num_per_repeat
+			+ sorted_start_offset_original_indices[route_start_offsets_begin[route_index]];
+	} else {
+		return repeat_number*num_per_repeat
+			+ sorted_start_offset_original_indices[std::distance(sorted_start_offsets.begin(), found)];
+	}
+}
+
+Timetable::Time Timetable::getDepartureTime(RouteID route, TrainIndex train_index) const {
+	const auto route_index = route.getValue();
+	const auto offsets_begin = route_start_offsets_begin[route_index];
+	const auto num_per_repeat = route_start_offsets_begin[route_index + 1] - offsets_begin;
+
+	return route_repeat_times[route_index]*(train_index / num_per_repeat)
+		+ start_offsets[offsets_begin + train_index % num_per_repeat];
+}
+
+} // end namespace algo
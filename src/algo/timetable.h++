@@ -0,0 +1,121 @@
+#ifndef ALGO__TIMETABLE_HPP
+#define ALGO__TIMETABLE_HPP
+
+#include <algo/scheduler.h++>
+#include <algo/train_route.h++>
+#include <util/track_network.h++>
+
+#include <boost/range/iterator_range.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace algo {
+
+/**
+ * An immutable, compiled form of a Schedule, for answering "when is the next
+ * train" type queries quickly.
+ *
+ * Every stop of every TrainRoute gets a dense StopIndex (routes' stops are
+ * contiguous, in path order), and each stop stores its arrival time relative
+ * to the train's departure. Because every train on a route repeats with the
+ * route's repeat time, the sorted start offsets plus the stop's arrival offset
+ * is the sorted arrival time array for that stop, and finding the next train
+ * is a binary search instead of a walk of the route.
+ *
+ * Also stores, for each vertex of the TrackNetwork, the list of stops that
+ * are at that vertex.
+ */
+class Timetable {
+public:
+	using StopIndex = uint32_t;
+	using Time = TrackNetwork::Time;
+
+	static const StopIndex INVALID_STOP;
+
+	Timetable(const Schedule& sch, const TrackNetwork& tn);
+
+	Timetable(const Timetable&) = default;
+	Timetable(Timetable&&) = default;
+	Timetable& operator=(const Timetable&) = default;
+	Timetable& operator=(Timetable&&) = default;
+
+	/**
+	 * Was this compiled from (the current contents of) sch?
+	 */
+	bool isCompiledFrom(const Schedule& sch) const { return sch.getSerialNumber() == schedule_serial_number; }
+
+	size_t getNumStops() const { return stop_vertices.size(); }
+	size_t getNumVertices() const { return vertex_stops_begin.size() - 1; }
+
+	/**
+	 * All the stops at vertex v, in the order of their StopIndexes
+	 */
+	auto getStopsAt(TrackNetwork::NodeID v) const {
+		return ::boost::make_iterator_range(
+			vertex_stops.begin() + vertex_stops_begin[v],
+			vertex_stops.begin() + vertex_stops_begin[v+1]
+		);
+	}
+
+	RouteID getRouteOf(StopIndex stop) const { return stop_routes[stop]; }
+	TrackNetwork::NodeID getVertexOf(StopIndex stop) const { return stop_vertices[stop]; }
+	Time getArrivalOffsetOf(StopIndex stop) const { return stop_arrival_offsets[stop]; }
+
+	/**
+	 * The stop at the start of route's path. The rest follow in order, see getNextStop
+	 */
+	StopIndex getFirstStopOf(RouteID route) const { return route_stops_begin[route.getValue()]; }
+
+	/**
+	 * The stop after this one on the same route, or INVALID_STOP if this is the last
+	 */
+	StopIndex getNextStop(StopIndex stop) const {
+		const auto next_stop = stop + 1;
+		if (next_stop == route_stops_begin[stop_routes[stop].getValue() + 1]) {
+			return INVALID_STOP;
+		} else {
+			return next_stop;
+		}
+	}
+
+	/**
+	 * The time that the train with index train_index will arrive at stop
+	 */
+	Time getArrivalTime(StopIndex stop, TrainIndex train_index) const {
+		return getDepartureTime(stop_routes[stop], train_index) + stop_arrival_offsets[stop];
+	}
+
+	/**
+	 * The index of the first train that arrives at stop at or after time t.
+	 * Trains only exist from t = 0 onwards, as in the simulator.
+	 */
+	TrainIndex getFirstTrainArrivingAtOrAfter(StopIndex stop, Time t) const;
+
+	Time getDepartureTime(RouteID route, TrainIndex train_index) const;
+
+private:
+	uint64_t schedule_serial_number;
+
+	// per route. the *_begin ones have an extra element at the end
+	std::vector<StopIndex> route_stops_begin;
+	std::vector<size_t> route_start_offsets_begin;
+	std::vector<Time> route_repeat_times;
+
+	// per stop
+	std::vector<RouteID> stop_routes;
+	std::vector<TrackNetwork::NodeID> stop_vertices;
+	std::vector<Time> stop_arrival_offsets;
+
+	// per route, concatenated. The sorted copy also keeps what index each was at in the TrainRoute
+	std::vector<Time> start_offsets;
+	std::vector<Time> sorted_start_offsets;
+	std::vector<TrainIndex> sorted_start_offset_original_indices;
+
+	// per vertex. vertex_stops_begin has an extra element at the end
+	std::vector<size_t> vertex_stops_begin;
+	std::vector<StopIndex> vertex_stops;
+};
+
+} // end namespace algo
+
+#endif /* ALGO__TIMETABLE_HPP */
@@ -181,6 +181,8 @@ public:
 
 	RouteID getID() const { return route_id; }
 	const RouteType& getPath() const { return route; }
+	const std::vector<TrackNetwork::Time>& getStartOffsets() const { return start_offsets; }
+	TrackNetwork::Time getRepeatTime() const { return repeat_time; }
 	Train::Speed getSpeed() const { return speed; }
 
 	auto getTrainsLeavingInInterval( // TODO rename to indicate generator return value
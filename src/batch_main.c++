@@ -0,0 +1,156 @@
+
+#include <algo/passenger_routing.h++>
+#include <algo/scheduler.h++>
+#include <parsing/input_parser.h++>
+#include <parsing/cmdargs_parser.h++>
+#include <parsing/snapshot.h++>
+#include <sim/simulator.h++>
+#include <stats/replication_stats.h++>
+#include <util/logging.h++>
+#include <util/metrics.h++>
+#include <util/passenger_generator.h++>
+#include <util/thread_utils.h++>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Headless entry point. Schedules once, then simulates the schedule many
+ * times with different passenger generator seeds, and reports the
+ * distribution of the results. Doesn't use (or link) the graphics.
+ */
+
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args);
+
+int main(int argc, char const** argv) {
+
+	dout.setHighestTitleRank(7);
+
+	auto parsed_args = parsing::cmdargs::parse(argc,argv);
+
+	// enable logging levels
+	for (auto& l : parsed_args.getDebugLevelsToEnable()) {
+		dout.enable_level(l);
+	}
+
+	// only pay for metrics if they are going to be written out
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		metrics::enable();
+	}
+
+	return program_main(parsed_args);
+}
+
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args) {
+
+	// these will be shared by all the simulations
+	auto tn = std::make_shared<TrackNetwork>();
+	auto passengers = std::make_shared<parsing::input::StatPassCollection>();
+
+	bool data_is_good;
+
+	std::ifstream graph_in(parsed_args.getDataFileName());
+
+	// get the data
+	std::tie(*tn,*passengers,data_is_good) = parsing::input::parse_data(graph_in);
+
+	// if the data is bad, exit
+	if (data_is_good == false) {
+		return -1;
+	}
+
+	// do scheduling, or load a schedule saved by an earlier run
+	std::shared_ptr<algo::Schedule> schedule = std::make_shared<algo::Schedule>();
+	try {
+		if (parsed_args.getScheduleLoadFileName().empty()) {
+			(*schedule) = algo::schedule(*tn, *passengers);
+		} else {
+			(*schedule) = parsing::snapshot::Snapshot(parsed_args.getScheduleLoadFileName()).makeSchedule(*tn);
+		}
+
+		if (parsed_args.getScheduleSaveFileName().empty() == false) {
+			parsing::snapshot::save_snapshot(parsed_args.getScheduleSaveFileName(), *tn, *schedule);
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "ERROR: couldn't get a schedule: " << e.what() << '\n';
+		return -1;
+	}
+
+	// the simulator can't handle passengers with no route, so leave them out
+	const auto served_passengers = algo::get_served_demand(*tn, *schedule, *passengers);
+	if (served_passengers.size() != passengers->size()) {
+		std::cerr << "WARN: the schedule can't take " << (passengers->size() - served_passengers.size())
+			<< " of the " << passengers->size() << " passenger sources to their exits, leaving them out\n";
+	}
+
+	// the debug output would get all mixed up
+	auto num_threads = parsed_args.getNumThreads();
+	if (dout(DL::SIM_D1).enabled() || dout(DL::PR_D1).enabled()) {
+		num_threads = 1;
+	}
+
+	std::vector<::stats::RunSummary> run_summaries(parsed_args.getNumRuns());
+	std::vector<std::string> run_errors(run_summaries.size()); // empty if the run worked
+
+	::util::parallel_for_index(run_summaries.size(), num_threads, [&](size_t irun) {
+		// each generator in a sample gets the next seed, so space the runs out to keep them independent
+		const PassengerGeneratorFactory::Seed seed = parsed_args.getFirstSeed() + irun*served_passengers.size();
+
+		// one run failing shouldn't take the others with it
+		try {
+			PassengerGeneratorFactory pgen_factory(seed, served_passengers);
+			auto pgen_sample = pgen_factory.sample();
+
+			auto sim_handle = ::sim::instantiate_simulator(
+				&pgen_sample,
+				schedule,
+				tn
+			);
+
+			// long runs can forget passengers as they exit, and just keep running statistics
+			if (parsed_args.shouldKeepExitedPassengers()) {
+				sim_handle.runForTime(parsed_args.getSimulationTime(), 1);
+				run_summaries[irun] = ::stats::summarize_run(sim_handle);
+			} else {
+				::stats::StreamingPassengerStats streaming_stats(*tn);
+				streaming_stats.observe(sim_handle);
+				sim_handle.setKeepExitedPassengers(false);
+				sim_handle.runForTime(parsed_args.getSimulationTime(), 1);
+				run_summaries[irun] = ::stats::summarize_run(sim_handle, streaming_stats);
+			}
+		} catch (const std::exception& e) {
+			run_errors[irun] = "run " + std::to_string(irun) + " (seed " + std::to_string(seed) + ") failed: " + e.what();
+		}
+	});
+
+	// only report on the runs that worked
+	std::vector<::stats::RunSummary> successful_run_summaries;
+	size_t num_failed_runs = 0;
+	for (size_t irun = 0; irun != run_summaries.size(); ++irun) {
+		if (run_errors[irun].empty()) {
+			successful_run_summaries.push_back(std::move(run_summaries[irun]));
+		} else {
+			std::cerr << "ERROR: " << run_errors[irun] << '\n';
+			num_failed_runs += 1;
+		}
+	}
+
+	std::ofstream report_file("replication_reports.txt");
+	::stats::report_replications(successful_run_summaries, report_file);
+
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		std::ofstream metrics_file(parsed_args.getMetricsFileName());
+		metrics::write(metrics_file, parsed_args.getMetricsFormat());
+	}
+
+	if (num_failed_runs != 0) {
+		std::cerr << "ERROR: " << num_failed_runs << " of the " << run_summaries.size() << " runs failed\n";
+		return 1;
+	}
+
+	return 0;
+}
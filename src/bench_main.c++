@@ -0,0 +1,366 @@
+
+#include <algo/passenger_routing.h++>
+#include <algo/scheduler.h++>
+#include <algo/timetable.h++>
+#include <parsing/cmdargs_parser.h++>
+#include <sim/simulator.h++>
+#include <stats/replication_stats.h++>
+#include <stats/report_config.h++>
+#include <stats/report_engine.h++>
+#include <util/logging.h++>
+#include <util/metrics.h++>
+#include <util/network_generators.h++>
+#include <util/passenger_generator.h++>
+#include <util/routing_utils.h++>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Benchmarking entry point. Generates a network and passenger demand for each
+ * topology and size asked for, then separately times the scheduler, the
+ * simulator, passenger routing, the report engine and the shortest path
+ * oracle on it, a few times each. Passengers that the schedule can't serve
+ * are counted, then left out. The results are written as JSON. Doesn't use
+ * (or link) the graphics.
+ */
+
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args);
+
+int main(int argc, char const** argv) {
+
+	dout.setHighestTitleRank(7);
+
+	auto parsed_args = parsing::cmdargs::parse(argc,argv);
+
+	// enable logging levels
+	for (auto& l : parsed_args.getDebugLevelsToEnable()) {
+		dout.enable_level(l);
+	}
+
+	// only pay for metrics if they are going to be written out
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		metrics::enable();
+	}
+
+	return program_main(parsed_args);
+}
+
+namespace {
+
+// same as "rate=1/1000" in the files in data/
+const StatisticalPassenger::AverageRate PASSENGER_RATE = 0.1;
+
+/**
+ * If adding one, make sure to update the names below
+ */
+enum class BenchmarkPhase {
+	SCHEDULE,
+	SIMULATE,
+	ROUTE,
+	REPORT,
+	SHORTEST_PATH_PREPROCESS,
+	SHORTEST_PATH_QUERY,
+
+	COUNT, // please make sure this is at the end
+};
+
+const std::array<const char*, static_cast<size_t>(BenchmarkPhase::COUNT)> phase_names {
+	"schedule",
+	"simulate",
+	"route",
+	"report",
+	"shortest_path_preprocess",
+	"shortest_path_query",
+};
+
+// what the throughput of each phase is measured in
+const std::array<const char*, static_cast<size_t>(BenchmarkPhase::COUNT)> phase_item_names {
+	"passenger_sources",
+	"passengers",
+	"passengers",
+	"passengers",
+	"stations",
+	"queries",
+};
+
+struct PhaseResults {
+	::stats::SampleStatistics seconds;
+	size_t total_items;
+	double total_seconds;
+
+	PhaseResults() : seconds(), total_items(0), total_seconds(0) { }
+};
+
+struct CaseResults {
+	::util::NetworkTopology topology;
+	size_t size;
+	size_t num_stations;
+	size_t num_tracks;
+	size_t num_passenger_sources;
+	size_t num_unserved_passenger_sources;
+	size_t num_train_routes;
+	long peak_memory_kib;
+	std::string error;
+	std::array<PhaseResults, static_cast<size_t>(BenchmarkPhase::COUNT)> phases;
+
+	CaseResults(::util::NetworkTopology topology, size_t size)
+		: topology(topology)
+		, size(size)
+		, num_stations(0)
+		, num_tracks(0)
+		, num_passenger_sources(0)
+		, num_unserved_passenger_sources(0)
+		, num_train_routes(0)
+		, peak_memory_kib(0)
+		, error()
+		, phases()
+	{ }
+};
+
+/**
+ * Peak resident memory since the last call, in KiB. Uses Linux's resettable
+ * high water mark (VmHWM) if it can, otherwise the peak of the whole process so far.
+ */
+long get_and_reset_peak_memory_kib() {
+	long result = -1;
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line)) {
+			if (line.compare(0, 6, "VmHWM:") == 0) {
+				result = std::stol(line.substr(6));
+			}
+		}
+	}
+
+	std::ofstream clear_refs("/proc/self/clear_refs");
+	clear_refs << "5";
+
+	if (result < 0 || !clear_refs) {
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		result = usage.ru_maxrss;
+	}
+	return result;
+}
+
+/**
+ * Call func, which returns how many items it processed, and record how long it took
+ */
+template<typename FUNC>
+void time_phase(CaseResults& results, BenchmarkPhase phase, FUNC&& func) {
+	auto& phase_results = results.phases[static_cast<size_t>(phase)];
+	const auto start = std::chrono::steady_clock::now();
+	const size_t num_items = func();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	phase_results.seconds.add(seconds);
+	phase_results.total_items += num_items;
+	phase_results.total_seconds += seconds;
+}
+
+CaseResults run_case(::util::NetworkTopology topology, size_t size, const parsing::cmdargs::ParsedArguments& parsed_args) {
+	auto indent = dout(DL::INFO).indentWithTitle([&](auto&& str) {
+		str << "benchmarking " << ::util::get_topology_name(topology) << " network of size " << size;
+	});
+
+	CaseResults results(topology, size);
+	get_and_reset_peak_memory_kib();
+
+	try {
+		auto tn = std::make_shared<TrackNetwork>(::util::make_network(topology, size));
+		results.num_stations = num_vertices(tn->g());
+		results.num_tracks = num_edges(tn->g());
+
+		// about one source of passengers for every other station
+		const auto passengers = ::util::make_demand(*tn, (results.num_stations + 1)/2, PASSENGER_RATE, parsed_args.getFirstSeed());
+		results.num_passenger_sources = passengers.size();
+
+		// scheduling is deterministic, so every repetition leaves the same ones unserved
+		const auto served_passengers = algo::get_served_demand(*tn, algo::schedule(*tn, passengers), passengers);
+		results.num_unserved_passenger_sources = passengers.size() - served_passengers.size();
+
+		for (size_t irep = 0; irep != parsed_args.getBenchmarkRepetitions(); ++irep) {
+			auto schedule = std::make_shared<algo::Schedule>();
+			time_phase(results, BenchmarkPhase::SCHEDULE, [&]() {
+				(*schedule) = algo::schedule(*tn, passengers);
+				return passengers.size();
+			});
+			results.num_train_routes = schedule->getNumTrainRoutes();
+
+			// each generator in a sample gets the next seed, so space the repetitions out to keep them independent
+			PassengerGeneratorFactory pgen_factory(parsed_args.getFirstSeed() + irep*served_passengers.size(), served_passengers);
+			auto pgen_sample = pgen_factory.sample();
+			auto sim_handle = ::sim::instantiate_simulator(&pgen_sample, schedule, tn);
+			time_phase(results, BenchmarkPhase::SIMULATE, [&]() {
+				sim_handle.runForTime(parsed_args.getSimulationTime(), 1);
+				return sim_handle.getPassengerList().size();
+			});
+
+			PassengerList sim_passengers;
+			for (const auto& value_pair : sim_handle.getPassengerList()) {
+				sim_passengers.push_back(value_pair.second);
+			}
+			time_phase(results, BenchmarkPhase::ROUTE, [&]() {
+				algo::route_passengers(*tn, *schedule, sim_passengers, algo::RouteTroughScheduleCacheHandle(), parsed_args.getNumThreads());
+				return sim_passengers.size();
+			});
+
+			time_phase(results, BenchmarkPhase::REPORT, [&]() {
+				auto report_engine_ptr = ::stats::make_report_engine(*tn, *schedule, sim_handle);
+				std::ostringstream report_sink;
+
+				using ::stats::ReportConfig;
+				for (const auto& type : {
+					ReportConfig::ReportType::PASSENGER_ROUTE_STATS,
+					ReportConfig::ReportType::SIMULATION_PASSENGER_STATS,
+					ReportConfig::ReportType::TRAIN_ROUTES,
+				}) {
+					::stats::report_into(*report_engine_ptr, ReportConfig(type), report_sink);
+				}
+				return sim_passengers.size();
+			});
+
+			// what the schedulers ask for: the route from each passenger source's entry to exit
+			std::unique_ptr<::util::TrackNetworkShortestPathOracle> shortest_path_oracle;
+			time_phase(results, BenchmarkPhase::SHORTEST_PATH_PREPROCESS, [&]() {
+				shortest_path_oracle = std::make_unique<::util::TrackNetworkShortestPathOracle>(::util::make_shortest_path_oracle(*tn));
+				return results.num_stations;
+			});
+			time_phase(results, BenchmarkPhase::SHORTEST_PATH_QUERY, [&]() {
+				for (const auto& p : passengers) {
+					shortest_path_oracle->getRoute(p.getEntryID(), p.getExitID());
+				}
+				return passengers.size();
+			});
+		}
+	} catch (const std::exception& e) {
+		// record it, and carry on with the other cases
+		results.error = e.what();
+	}
+
+	results.peak_memory_kib = get_and_reset_peak_memory_kib();
+	return results;
+}
+
+void write_json_string(std::ostream& os, const std::string& str) {
+	os << '"';
+	for (const char c : str) {
+		switch (c) {
+			case '"':  os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n";  break;
+			case '\t': os << "\\t";  break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					os << ' ';
+				} else {
+					os << c;
+				}
+		}
+	}
+	os << '"';
+}
+
+void write_results(std::ostream& os, const std::vector<CaseResults>& all_results, const parsing::cmdargs::ParsedArguments& parsed_args) {
+	os << "{\n";
+#ifdef DEBUG
+	os << "\t\"build_mode\": \"debug\",\n";
+#else
+	os << "\t\"build_mode\": \"release\",\n";
+#endif
+	os << "\t\"simulation_time\": " << parsed_args.getSimulationTime() << ",\n";
+	os << "\t\"repetitions\": " << parsed_args.getBenchmarkRepetitions() << ",\n";
+	os << "\t\"cases\": [";
+
+	for (size_t icase = 0; icase != all_results.size(); ++icase) {
+		const auto& results = all_results[icase];
+		os << (icase == 0 ? "\n" : ",\n") << "\t\t{\n";
+		os << "\t\t\t\"topology\": \"" << ::util::get_topology_name(results.topology) << "\",\n";
+		os << "\t\t\t\"size\": " << results.size << ",\n";
+		os << "\t\t\t\"num_stations\": " << results.num_stations << ",\n";
+		os << "\t\t\t\"num_tracks\": " << results.num_tracks << ",\n";
+		os << "\t\t\t\"num_passenger_sources\": " << results.num_passenger_sources << ",\n";
+		os << "\t\t\t\"num_unserved_passenger_sources\": " << results.num_unserved_passenger_sources << ",\n";
+		os << "\t\t\t\"num_train_routes\": " << results.num_train_routes << ",\n";
+		os << "\t\t\t\"peak_memory_kib\": " << results.peak_memory_kib << ",\n";
+		os << "\t\t\t\"error\": ";
+		if (results.error.empty()) {
+			os << "null";
+		} else {
+			write_json_string(os, results.error);
+		}
+		os << ",\n";
+
+		os << "\t\t\t\"phases\": {";
+		for (size_t iphase = 0; iphase != phase_names.size(); ++iphase) {
+			const auto& phase = results.phases[iphase];
+			os << (iphase == 0 ? "\n" : ",\n") << "\t\t\t\t\"" << phase_names[iphase] << "\": {"
+				<< " \"samples\": " << phase.seconds.size()
+				<< ", \"items\": \"" << phase_item_names[iphase] << "\""
+				<< ", \"items_per_second\": " << (phase.total_seconds == 0 ? 0.0 : phase.total_items / phase.total_seconds)
+				<< ", \"seconds_per_item\": " << (phase.total_items == 0 ? 0.0 : phase.total_seconds / phase.total_items)
+				<< ", \"seconds\": {"
+				<< " \"mean\": " << (phase.seconds.size() == 0 ? 0.0 : phase.seconds.mean())
+				<< ", \"min\": " << phase.seconds.quantile(0)
+				<< ", \"p50\": " << phase.seconds.quantile(0.5)
+				<< ", \"p90\": " << phase.seconds.quantile(0.9)
+				<< ", \"p99\": " << phase.seconds.quantile(0.99)
+				<< ", \"max\": " << phase.seconds.quantile(1)
+				<< " } }";
+		}
+		os << "\n\t\t\t}\n";
+		os << "\t\t}";
+	}
+
+	os << "\n\t]\n";
+	os << "}\n";
+}
+
+} // end anonymous namespace
+
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args) {
+
+	// smallest first, so a regression shows up before the big ones take forever
+	auto sizes = parsed_args.getBenchmarkSizes();
+	std::sort(begin(sizes), end(sizes));
+
+	auto topologies = ::util::get_all_topologies();
+	if (parsed_args.getBenchmarkTopologyNames().empty() == false) {
+		topologies.clear();
+		for (const auto& name : parsed_args.getBenchmarkTopologyNames()) {
+			const auto topology = ::util::get_topology_from_string(name);
+			if (topology.second) {
+				topologies.push_back(topology.first);
+			} else {
+				std::cerr << "WARN: unknown network topology \"" << name << "\", ignoring it\n";
+			}
+		}
+	}
+
+	std::vector<CaseResults> all_results;
+	for (const auto& size : sizes) {
+		for (const auto& topology : topologies) {
+			all_results.push_back(run_case(topology, size, parsed_args));
+		}
+	}
+
+	std::ofstream results_file(parsed_args.getBenchmarkOutputFileName());
+	write_results(results_file, all_results, parsed_args);
+
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		std::ofstream metrics_file(parsed_args.getMetricsFileName());
+		metrics::write(metrics_file, parsed_args.getMetricsFormat());
+	}
+
+	return 0;
+}
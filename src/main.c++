@@ -3,9 +3,12 @@
 #include <graphics/graphics.h++>
 #include <parsing/input_parser.h++>
 #include <parsing/cmdargs_parser.h++>
+#include <parsing/snapshot.h++>
 #include <stats/report_config.h++>
 #include <stats/report_engine.h++>
+#include <stats/streaming_stats.h++>
 #include <util/logging.h++>
+#include <util/metrics.h++>
 #include <util/passenger_generator.h++>
 
 #include <memory>
@@ -16,7 +19,7 @@
 #include <unordered_set>
 #include <vector>
 
-int program_main(const std::string& data_file_name);
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args);
 
 int main(int argc, char const** argv) {
 
@@ -35,10 +38,15 @@ int main(int argc, char const** argv) {
 		dout.enable_level(l);
 	}
 
-	return program_main(parsed_args.getDataFileName());
+	// only pay for metrics if they are going to be written out
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		metrics::enable();
+	}
+
+	return program_main(parsed_args);
 }
 
-int program_main(const std::string& data_file_name) {
+int program_main(const parsing::cmdargs::ParsedArguments& parsed_args) {
 
 	std::list<std::thread> sim_threads;
 
@@ -48,7 +56,7 @@ int program_main(const std::string& data_file_name) {
 
 	bool data_is_good;
 
-	std::ifstream graph_in(data_file_name);
+	std::ifstream graph_in(parsed_args.getDataFileName());
 
 	// get the data
 	std::tie(*tn,*passengers,data_is_good) = parsing::input::parse_data(graph_in);
@@ -69,9 +77,17 @@ int program_main(const std::string& data_file_name) {
 	// graphics::get().trainsArea().displayTNAndPassengers(tn,passengers);
 	graphics::get().waitForPress();
 
-	// do scheduling
+	// do scheduling, or load a schedule saved by an earlier run
 	std::shared_ptr<algo::Schedule> schedule = std::make_shared<algo::Schedule>();
-	(*schedule) = algo::schedule(*tn, *passengers);
+	if (parsed_args.getScheduleLoadFileName().empty()) {
+		(*schedule) = algo::schedule(*tn, *passengers);
+	} else {
+		(*schedule) = parsing::snapshot::Snapshot(parsed_args.getScheduleLoadFileName()).makeSchedule(*tn);
+	}
+
+	if (parsed_args.getScheduleSaveFileName().empty() == false) {
+		parsing::snapshot::save_snapshot(parsed_args.getScheduleSaveFileName(), *tn, *schedule);
+	}
 
 	// display schedule
 	graphics::get().trainsArea().presentResults(tn,{},schedule);
@@ -83,19 +99,33 @@ int program_main(const std::string& data_file_name) {
 		tn
 	);
 
+	// fold passengers into statistics as they exit, if anything wants them
+	std::shared_ptr<::stats::StreamingPassengerStats> streaming_stats;
+	if (parsed_args.getPassengerRecordsFileName().empty() == false || parsed_args.shouldKeepExitedPassengers() == false) {
+		std::unique_ptr<std::ostream> records_os;
+		if (parsed_args.getPassengerRecordsFileName().empty() == false) {
+			records_os = std::make_unique<std::ofstream>(parsed_args.getPassengerRecordsFileName());
+		}
+		streaming_stats = std::make_shared<::stats::StreamingPassengerStats>(*tn, std::move(records_os));
+		streaming_stats->observe(sim_handle);
+	}
+	sim_handle.setKeepExitedPassengers(parsed_args.shouldKeepExitedPassengers());
+
 	// display a simulation
 	graphics::get().trainsArea().displaySimulator(sim_handle);
 
 	sim_threads.emplace_back([](
 		auto l_tn,
 		auto l_schedule,
-		auto l_sim_handle
+		auto l_sim_handle,
+		auto l_streaming_stats,
+		bool kept_exited_passengers
 	) noexcept {
 
 		l_sim_handle.runForTime(100, 0.3);
 
 		auto report_engine_ptr = ::stats::make_report_engine(
-			*l_tn, *l_schedule, l_sim_handle
+			*l_tn, *l_schedule, l_sim_handle, l_streaming_stats.get()
 		);
 
 		std::ofstream report_file("reports.txt");
@@ -104,14 +134,23 @@ int program_main(const std::string& data_file_name) {
 		const ReportConfig conf_prs(ReportConfig::ReportType::PASSENGER_ROUTE_STATS);
 		const ReportConfig conf_sps(ReportConfig::ReportType::SIMULATION_PASSENGER_STATS);
 		const ReportConfig conf_trains(ReportConfig::ReportType::TRAIN_ROUTES);
+		const ReportConfig conf_pas(ReportConfig::ReportType::PASSENGER_AGGREGATE_STATS);
 
-		::stats::report_into(*report_engine_ptr, conf_prs, report_file);
-		::stats::report_into(*report_engine_ptr, conf_sps, report_file);
+		// these go through every passenger, so would be missing the ones that exited
+		if (kept_exited_passengers) {
+			::stats::report_into(*report_engine_ptr, conf_prs, report_file);
+			::stats::report_into(*report_engine_ptr, conf_sps, report_file);
+		}
 		::stats::report_into(*report_engine_ptr, conf_trains, report_file);
+		if (l_streaming_stats) {
+			::stats::report_into(*report_engine_ptr, conf_pas, report_file);
+		}
 	},
 		tn,
 		schedule,
-		sim_handle
+		sim_handle,
+		streaming_stats,
+		parsed_args.shouldKeepExitedPassengers()
 	);
 
 	graphics::get().waitForPress();
@@ -123,5 +162,10 @@ int program_main(const std::string& data_file_name) {
 		thread.join();
 	}
 
+	if (parsed_args.getMetricsFileName().empty() == false) {
+		std::ofstream metrics_file(parsed_args.getMetricsFileName());
+		metrics::write(metrics_file, parsed_args.getMetricsFormat());
+	}
+
 	return 0;
 }
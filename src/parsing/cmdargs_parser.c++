@@ -1,14 +1,65 @@
 
 #include "cmdargs_parser.h++"
 
+#include <algorithm>
+#include <iostream>
+
 namespace parsing {
 
 namespace cmdargs {
 
+namespace {
+	/**
+	 * If flag is present and followed by something, convert that with std::sto*
+	 * style convert, and put it in value.
+	 */
+	template<typename T, typename CONVERT>
+	void get_flag_value(const std::vector<std::string>& args, const std::string& flag, T& value, CONVERT&& convert) {
+		auto flag_it = std::find(begin(args),end(args),flag);
+		if (flag_it != end(args)) {
+			auto value_it = std::next(flag_it);
+			if (value_it != end(args)) {
+				value = convert(*value_it);
+			}
+		}
+	}
+
+	/**
+	 * Split a comma separated list, and convert each element
+	 */
+	template<typename CONVERT>
+	auto split_list(const std::string& str, CONVERT&& convert) {
+		std::vector<decltype(convert(str))> result;
+		std::string::size_type elem_begin = 0;
+		while (elem_begin <= str.size()) {
+			auto elem_end = std::min(str.find(',', elem_begin), str.size());
+			if (elem_end != elem_begin) {
+				result.push_back(convert(str.substr(elem_begin, elem_end - elem_begin)));
+			}
+			elem_begin = elem_end + 1;
+		}
+		return result;
+	}
+}
+
 ParsedArguments::ParsedArguments(int argc_int, char const** argv)
 	: graphics_enabled(false)
 	, levels_to_enable(DebugLevel::getDefaultSet())
 	, data_file_name()
+	, num_runs(100)
+	, num_threads(0)
+	, simulation_time(100)
+	, first_seed(1)
+	, schedule_save_file_name()
+	, schedule_load_file_name()
+	, metrics_file_name()
+	, metrics_format(metrics::OutputFormat::JSON)
+	, benchmark_topology_names()
+	, benchmark_sizes{64, 256, 1024}
+	, benchmark_repetitions(5)
+	, benchmark_output_file_name("benchmark_results.json")
+	, passenger_records_file_name()
+	, keep_exited_passengers(true)
  {
 	uint arg_count = argc_int;
 	std::vector<std::string> args;
@@ -22,6 +73,10 @@ ParsedArguments::ParsedArguments(int argc_int, char const** argv)
 		graphics_enabled = true;
 	}
 
+	if (std::find(begin(args),end(args),"--drop-exited-passengers") != end(args)) {
+		keep_exited_passengers = false;
+	}
+
 	if (std::find(begin(args),end(args),"--debug") != end(args)) {
 		auto debug_levels = DebugLevel::getStandardDebug();
 		levels_to_enable.insert(end(levels_to_enable),begin(debug_levels),end(debug_levels));
@@ -40,14 +95,34 @@ ParsedArguments::ParsedArguments(int argc_int, char const** argv)
 		}
 	}
 
-	{
-		auto data_flag_it = std::find(begin(args),end(args),"--data-file");
-		if (data_flag_it != end(args)) {
-			auto data_file_it = std::next(data_flag_it);
-			if (data_file_it != end(args)) {
-				data_file_name = *data_file_it;
-			}
+	get_flag_value(args, "--data-file", data_file_name, [](const std::string& str) { return str; });
+	get_flag_value(args, "--num-runs", num_runs, [](const std::string& str) { return std::stoul(str); });
+	get_flag_value(args, "--num-threads", num_threads, [](const std::string& str) { return std::stoul(str); });
+	get_flag_value(args, "--sim-time", simulation_time, [](const std::string& str) { return std::stod(str); });
+	get_flag_value(args, "--seed", first_seed, [](const std::string& str) { return std::stoull(str); });
+	get_flag_value(args, "--save-schedule", schedule_save_file_name, [](const std::string& str) { return str; });
+	get_flag_value(args, "--load-schedule", schedule_load_file_name, [](const std::string& str) { return str; });
+	get_flag_value(args, "--metrics-file", metrics_file_name, [](const std::string& str) { return str; });
+	get_flag_value(args, "--metrics-format", metrics_format, [](const std::string& str) {
+		const auto result = metrics::get_output_format_from_string(str);
+		if (result.second == false) {
+			std::cerr << "WARN: unknown metrics format \"" << str << "\", using json\n";
 		}
+		return result.first;
+	});
+	get_flag_value(args, "--topologies", benchmark_topology_names, [](const std::string& str) {
+		return split_list(str, [](const std::string& elem) { return elem; });
+	});
+	get_flag_value(args, "--sizes", benchmark_sizes, [](const std::string& str) {
+		return split_list(str, [](const std::string& elem) { return std::stoul(elem); });
+	});
+	get_flag_value(args, "--repetitions", benchmark_repetitions, [](const std::string& str) { return std::stoul(str); });
+	get_flag_value(args, "--benchmark-file", benchmark_output_file_name, [](const std::string& str) { return str; });
+	get_flag_value(args, "--passenger-records-file", passenger_records_file_name, [](const std::string& str) { return str; });
+
+	if (std::any_of(begin(levels_to_enable), end(levels_to_enable), [](const auto& l) { return !DebugLevel::isCompiledIn(l); })) {
+		// dout's levels aren't enabled yet
+		std::cerr << "WARN: debug output was asked for, but this is a release build, which has it compiled out\n";
 	}
 
 }
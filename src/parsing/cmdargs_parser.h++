@@ -3,8 +3,11 @@
 #define PARSING__CMDARGS_PARSER_H
 
 #include <util/logging.h++>
+#include <util/metrics.h++>
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace parsing {
 
@@ -26,6 +29,51 @@ public:
 	bool shouldEnableGraphics() const  { return graphics_enabled; }
 	const std::string& getDataFileName() const { return data_file_name; }
 
+	/**
+	 * For running many simulations: how many, on how many threads (0 means all cores),
+	 * for how long each, and the passenger generator seed of the first one.
+	 */
+	size_t getNumRuns() const { return num_runs; }
+	size_t getNumThreads() const { return num_threads; }
+	double getSimulationTime() const { return simulation_time; }
+	uint64_t getFirstSeed() const { return first_seed; }
+
+	/**
+	 * Files to save the schedule to after scheduling, and to load one from instead
+	 * of scheduling. See parsing/snapshot.h++. Empty if not given.
+	 */
+	const std::string& getScheduleSaveFileName() const { return schedule_save_file_name; }
+	const std::string& getScheduleLoadFileName() const { return schedule_load_file_name; }
+
+	/**
+	 * Where to write the metrics (see util/metrics.h++), and in what format.
+	 * Metrics are only collected if the file name is not empty.
+	 */
+	const std::string& getMetricsFileName() const { return metrics_file_name; }
+	metrics::OutputFormat getMetricsFormat() const { return metrics_format; }
+
+	/**
+	 * For benchmarking: the names of the network shapes (see util/network_generators.h++,
+	 * empty means all of them) and the sizes to sweep over, how many times to repeat
+	 * each, and where to write the results.
+	 */
+	const std::vector<std::string>& getBenchmarkTopologyNames() const { return benchmark_topology_names; }
+	const std::vector<size_t>& getBenchmarkSizes() const { return benchmark_sizes; }
+	size_t getBenchmarkRepetitions() const { return benchmark_repetitions; }
+	const std::string& getBenchmarkOutputFileName() const { return benchmark_output_file_name; }
+
+	/**
+	 * Where to write a CSV record of each passenger as it exits the simulation
+	 * (see stats/streaming_stats.h++). Empty if not given.
+	 */
+	const std::string& getPassengerRecordsFileName() const { return passenger_records_file_name; }
+
+	/**
+	 * Should the simulator keep passengers after they exit? Reports about
+	 * every passenger need this, but it uses memory for the whole run.
+	 */
+	bool shouldKeepExitedPassengers() const { return keep_exited_passengers; }
+
 private:
 	friend ParsedArguments parse(int arc_int, char const** argv);
 
@@ -36,6 +84,25 @@ private:
 
 	std::string data_file_name;
 
+	size_t num_runs;
+	size_t num_threads;
+	double simulation_time;
+	uint64_t first_seed;
+
+	std::string schedule_save_file_name;
+	std::string schedule_load_file_name;
+
+	std::string metrics_file_name;
+	metrics::OutputFormat metrics_format;
+
+	std::vector<std::string> benchmark_topology_names;
+	std::vector<size_t> benchmark_sizes;
+	size_t benchmark_repetitions;
+	std::string benchmark_output_file_name;
+
+	std::string passenger_records_file_name;
+	bool keep_exited_passengers;
+
 	ParsedArguments(int arc_int, char const** argv);
 };
 
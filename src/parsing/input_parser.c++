@@ -1,6 +1,7 @@
 #include "input_parser.h++"
 
 #include <util/logging.h++>
+#include <util/metrics.h++>
 
 #include <iostream>
 #include <string>
@@ -30,6 +31,7 @@ namespace input {
 std::tuple<TrackNetwork,StatPassCollection, bool> parse_data(std::istream& is) {
 
 	auto indent = dout(DL::DATA_READ1).indentWithTitle("Reading Data");
+	metrics::ScopedTimer timer(metrics::Phase::PARSE);
 
 	TrackNetwork::BackingGraphType network;
 	StatPassCollection statpsgrs;
@@ -0,0 +1,442 @@
+#include "snapshot.h++"
+
+#include <util/logging.h++>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace parsing {
+namespace snapshot {
+
+namespace {
+
+/*
+ * File layout. Everything is in the byte order of the machine that wrote it, and
+ * every section starts on an 8 byte boundary, so the records can be used in place.
+ *
+ *   Header
+ *   VertexRecord[vertices.count]        one per vertex, in vertex order
+ *   EdgeRecord[edges.count]             in edges(g) order, which is each vertex's out-edges in order
+ *   RouteRecord[routes.count]           in Schedule order
+ *   uint64_t[path_vertices.count]       all the route paths, one after another
+ *   int64_t[start_offsets.count]        all the route start offsets, one after another
+ *   char[characters.count]              all the names, one after another, not null terminated
+ */
+
+const char MAGIC[8] = { 'T','S','C','H','S','N','A','P' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Section {
+	uint64_t offset; // from the start of the file
+	uint64_t count;  // of records
+};
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order_mark;
+	uint64_t train_spawn_location;
+	uint64_t schedule_name_offset; // into characters
+	uint64_t schedule_name_length;
+	Section vertices;
+	Section edges;
+	Section routes;
+	Section path_vertices;
+	Section start_offsets;
+	Section characters;
+};
+
+struct VertexRecord {
+	uint64_t name_offset; // into characters
+	uint64_t name_length;
+	double x;
+	double y;
+};
+
+struct EdgeRecord {
+	uint64_t source;
+	uint64_t target;
+	double weight;
+	uint32_t index;
+	uint32_t padding;
+};
+
+struct RouteRecord {
+	uint32_t route_id;
+	uint32_t padding;
+	int64_t repeat_time;
+	uint64_t path_offset; // into path_vertices
+	uint64_t path_length;
+	uint64_t start_offsets_offset; // into start_offsets
+	uint64_t start_offsets_length;
+};
+
+template<typename RECORD>
+void check_record_type() {
+	static_assert(std::is_trivially_copyable<RECORD>::value, "records are copied to and from the file as bytes");
+	static_assert(sizeof(RECORD) % 8 == 0, "records must keep the following ones aligned");
+}
+
+const uint64_t SECTION_ALIGNMENT = 8;
+
+uint64_t align_up(uint64_t offset) {
+	return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+/**
+ * Sets section's offset to the next aligned one after next_offset, then
+ * moves next_offset past it.
+ */
+template<typename RECORD>
+void lay_out_section(Section& section, uint64_t count, uint64_t& next_offset) {
+	section.offset = align_up(next_offset);
+	section.count = count;
+	next_offset = section.offset + count * sizeof(RECORD);
+}
+
+template<typename RECORD>
+void write_section(std::ostream& os, const Section& section, const std::vector<RECORD>& records) {
+	const auto padding = section.offset - static_cast<uint64_t>(os.tellp());
+	for (uint64_t i = 0; i != padding; ++i) {
+		os.put('\0');
+	}
+	os.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(RECORD));
+}
+
+} // end anonymous namespace
+
+void save_snapshot(const std::string& file_name, const TrackNetwork& tn, const ::algo::Schedule& sch) {
+	check_record_type<Header>();
+	check_record_type<VertexRecord>();
+	check_record_type<EdgeRecord>();
+	check_record_type<RouteRecord>();
+
+	std::vector<char> characters;
+	const auto add_characters = [&](const std::string& str) {
+		const uint64_t offset = characters.size();
+		characters.insert(characters.end(), str.begin(), str.end());
+		return offset;
+	};
+
+	std::vector<VertexRecord> vertex_records;
+	for (const auto& vdesc : make_iterable(vertices(tn.g()))) {
+		const auto& name = tn.getVertexName(vdesc);
+		const auto& position = tn.getVertexPosition(vdesc);
+		vertex_records.push_back(VertexRecord{ add_characters(name), name.size(), position.x, position.y });
+	}
+
+	std::vector<EdgeRecord> edge_records;
+	for (const auto& edesc : make_iterable(edges(tn.g()))) {
+		edge_records.push_back(EdgeRecord{
+			source(edesc, tn.g()),
+			target(edesc, tn.g()),
+			boost::get(&TrackNetwork::EdgeProperties::weight, tn.g(), edesc),
+			tn.getEdgeIndex(edesc),
+			0
+		});
+	}
+
+	std::vector<RouteRecord> route_records;
+	std::vector<uint64_t> path_vertices;
+	std::vector<int64_t> start_offsets;
+	for (const auto& train_route : sch.getTrainRoutes()) {
+		route_records.push_back(RouteRecord{
+			train_route.getID().getValue(),
+			0,
+			train_route.getRepeatTime(),
+			path_vertices.size(),
+			train_route.getPath().size(),
+			start_offsets.size(),
+			train_route.getStartOffsets().size()
+		});
+		path_vertices.insert(path_vertices.end(), train_route.getPath().begin(), train_route.getPath().end());
+		start_offsets.insert(start_offsets.end(), train_route.getStartOffsets().begin(), train_route.getStartOffsets().end());
+	}
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::copy(std::begin(MAGIC), std::end(MAGIC), std::begin(header.magic));
+	header.version = FORMAT_VERSION;
+	header.byte_order_mark = BYTE_ORDER_MARK;
+	header.train_spawn_location = tn.getTrainSpawnLocation();
+	header.schedule_name_length = sch.getName().size();
+	header.schedule_name_offset = add_characters(sch.getName());
+
+	uint64_t next_offset = sizeof(Header);
+	lay_out_section<VertexRecord>(header.vertices,      vertex_records.size(), next_offset);
+	lay_out_section<EdgeRecord>  (header.edges,         edge_records.size(),   next_offset);
+	lay_out_section<RouteRecord> (header.routes,        route_records.size(),  next_offset);
+	lay_out_section<uint64_t>    (header.path_vertices, path_vertices.size(),  next_offset);
+	lay_out_section<int64_t>     (header.start_offsets, start_offsets.size(),  next_offset);
+	lay_out_section<char>        (header.characters,    characters.size(),     next_offset);
+
+	std::ofstream os(file_name, std::ios::binary | std::ios::trunc);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	write_section(os, header.vertices,      vertex_records);
+	write_section(os, header.edges,         edge_records);
+	write_section(os, header.routes,        route_records);
+	write_section(os, header.path_vertices, path_vertices);
+	write_section(os, header.start_offsets, start_offsets);
+	write_section(os, header.characters,    characters);
+	os.close();
+
+	if (!os) {
+		::util::print_and_throw<std::runtime_error>([&](auto&& err) {
+			err << "could not write snapshot to " << file_name;
+		});
+	}
+
+	dout(DL::INFO) << "saved snapshot of " << vertex_records.size() << " vertices and " << route_records.size() << " train routes to " << file_name << '\n';
+}
+
+Snapshot::Snapshot(const std::string& file_name)
+	: mapping(nullptr)
+	, mapping_size(0)
+{
+	const auto fail = [&](const char* reason) {
+		::util::print_and_throw<std::runtime_error>([&](auto&& err) {
+			err << "could not load snapshot " << file_name << ": " << reason;
+		});
+	};
+
+	const int fd = open(file_name.c_str(), O_RDONLY);
+	if (fd == -1) {
+		fail("can't open it");
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == -1 || static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+		close(fd);
+		fail("too small to be a snapshot");
+	}
+
+	void* const map_result = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping stays valid
+	if (map_result == MAP_FAILED) {
+		fail("can't map it");
+	}
+	mapping = static_cast<const char*>(map_result);
+	mapping_size = file_stat.st_size;
+
+	// from here, the destructor won't run if we throw, so unmap first
+	const auto unmap_and_fail = [&](const char* reason) {
+		munmap(const_cast<char*>(mapping), mapping_size);
+		fail(reason);
+	};
+
+	const auto& header = *getRecords<Header>(0);
+	if (!std::equal(std::begin(MAGIC), std::end(MAGIC), std::begin(header.magic))) {
+		unmap_and_fail("not a snapshot file");
+	}
+	if (header.byte_order_mark != BYTE_ORDER_MARK) {
+		unmap_and_fail("written by a machine with a different byte order");
+	}
+	if (header.version != FORMAT_VERSION) {
+		unmap_and_fail("wrong format version");
+	}
+
+	const auto section_fits = [&](const Section& section, size_t record_size) {
+		return section.offset % SECTION_ALIGNMENT == 0
+			&& section.offset <= mapping_size
+			&& section.count <= (mapping_size - section.offset) / record_size;
+	};
+	if (
+		   !section_fits(header.vertices,      sizeof(VertexRecord))
+		|| !section_fits(header.edges,         sizeof(EdgeRecord))
+		|| !section_fits(header.routes,        sizeof(RouteRecord))
+		|| !section_fits(header.path_vertices, sizeof(uint64_t))
+		|| !section_fits(header.start_offsets, sizeof(int64_t))
+		|| !section_fits(header.characters,    sizeof(char))
+	) {
+		unmap_and_fail("truncated or corrupt section table");
+	}
+
+	// check every reference, so that the make* functions don't have to
+	const auto range_fits = [](uint64_t offset, uint64_t length, const Section& section) {
+		return offset <= section.count && length <= section.count - offset;
+	};
+	const auto num_vertices = header.vertices.count;
+
+	if (!range_fits(header.schedule_name_offset, header.schedule_name_length, header.characters)) {
+		unmap_and_fail("schedule name out of range");
+	}
+	if (header.train_spawn_location >= num_vertices && num_vertices != 0) {
+		unmap_and_fail("train spawn location out of range");
+	}
+	const auto vertex_records = getRecords<VertexRecord>(header.vertices.offset);
+	for (uint64_t i = 0; i != header.vertices.count; ++i) {
+		if (!range_fits(vertex_records[i].name_offset, vertex_records[i].name_length, header.characters)) {
+			unmap_and_fail("vertex name out of range");
+		}
+	}
+	// edge maps are indexed by these, so they must be exactly 0 to count-1
+	const auto edge_records = getRecords<EdgeRecord>(header.edges.offset);
+	std::vector<bool> edge_index_seen(header.edges.count, false);
+	for (uint64_t i = 0; i != header.edges.count; ++i) {
+		if (edge_records[i].source >= num_vertices || edge_records[i].target >= num_vertices) {
+			unmap_and_fail("edge endpoint out of range");
+		}
+		if (edge_records[i].index >= header.edges.count || edge_index_seen[edge_records[i].index]) {
+			unmap_and_fail("edge index out of range, or repeated");
+		}
+		edge_index_seen[edge_records[i].index] = true;
+	}
+
+	// times are stored wider than TrackNetwork::Time, so they have to fit before being narrowed
+	const auto fits_in_time = [](int64_t time) {
+		return std::numeric_limits<TrackNetwork::Time>::min() <= time && time <= std::numeric_limits<TrackNetwork::Time>::max();
+	};
+
+	// routes are looked up by indexing with their RouteID, so it has to be their position
+	const auto route_records = getRecords<RouteRecord>(header.routes.offset);
+	for (uint64_t i = 0; i != header.routes.count; ++i) {
+		if (route_records[i].route_id != i) {
+			unmap_and_fail("train route ID doesn't match its position");
+		}
+		if (
+			   !range_fits(route_records[i].path_offset, route_records[i].path_length, header.path_vertices)
+			|| !range_fits(route_records[i].start_offsets_offset, route_records[i].start_offsets_length, header.start_offsets)
+			|| route_records[i].path_length == 0
+			|| route_records[i].start_offsets_length == 0
+			|| route_records[i].repeat_time <= 0
+			|| !fits_in_time(route_records[i].repeat_time)
+		) {
+			unmap_and_fail("bad train route");
+		}
+	}
+	const auto path_vertices = getRecords<uint64_t>(header.path_vertices.offset);
+	if (std::any_of(path_vertices, path_vertices + header.path_vertices.count, [&](auto& v) { return v >= num_vertices; })) {
+		unmap_and_fail("train route vertex out of range");
+	}
+	const auto start_offsets = getRecords<int64_t>(header.start_offsets.offset);
+	if (!std::all_of(start_offsets, start_offsets + header.start_offsets.count, fits_in_time)) {
+		unmap_and_fail("train route start offset out of range");
+	}
+}
+
+Snapshot::~Snapshot() {
+	munmap(const_cast<char*>(mapping), mapping_size);
+}
+
+template<typename RECORD>
+const RECORD* Snapshot::getRecords(uint64_t offset) const {
+	return reinterpret_cast<const RECORD*>(mapping + offset);
+}
+
+TrackNetwork Snapshot::makeTrackNetwork() const {
+	const auto& header = *getRecords<Header>(0);
+	const auto vertex_records = getRecords<VertexRecord>(header.vertices.offset);
+	const auto edge_records = getRecords<EdgeRecord>(header.edges.offset);
+	const auto characters = getRecords<char>(header.characters.offset);
+
+	TrackNetwork::BackingGraphType network(header.vertices.count);
+	TrackNetwork::OffNodeDataPropertyMap off_node_data;
+
+	for (const auto& vdesc : make_iterable(vertices(network))) {
+		const auto& record = vertex_records[vdesc];
+		auto& data = off_node_data[vdesc];
+		data.name.assign(characters + record.name_offset, record.name_length);
+		data.location.set(record.x, record.y);
+	}
+
+	// adding in the same order gives each vertex the same out-edge order, so
+	// searches on the loaded network break ties the same way
+	for (uint64_t i = 0; i != header.edges.count; ++i) {
+		const auto& record = edge_records[i];
+		add_edge(record.source, record.target, TrackNetwork::EdgeProperties(record.weight, record.index), network);
+	}
+
+	TrackNetwork tn(std::move(network), std::move(off_node_data));
+	tn.setTrainSpawnLocation(header.train_spawn_location);
+	return tn;
+}
+
+bool Snapshot::matches(const TrackNetwork& tn) const {
+	const auto& header = *getRecords<Header>(0);
+	const auto vertex_records = getRecords<VertexRecord>(header.vertices.offset);
+	const auto edge_records = getRecords<EdgeRecord>(header.edges.offset);
+	const auto characters = getRecords<char>(header.characters.offset);
+
+	if (
+		   num_vertices(tn.g()) != header.vertices.count
+		|| num_edges(tn.g()) != header.edges.count
+		|| tn.getTrainSpawnLocation() != header.train_spawn_location
+	) {
+		return false;
+	}
+
+	for (const auto& vdesc : make_iterable(vertices(tn.g()))) {
+		const auto& record = vertex_records[vdesc];
+		const auto& name = tn.getVertexName(vdesc);
+		const auto& position = tn.getVertexPosition(vdesc);
+		if (
+			   name.size() != record.name_length
+			|| !std::equal(name.begin(), name.end(), characters + record.name_offset)
+			|| position.x != record.x
+			|| position.y != record.y
+		) {
+			return false;
+		}
+	}
+
+	const EdgeRecord* edge_record = edge_records;
+	for (const auto& edesc : make_iterable(edges(tn.g()))) {
+		if (
+			   source(edesc, tn.g()) != edge_record->source
+			|| target(edesc, tn.g()) != edge_record->target
+			|| boost::get(&TrackNetwork::EdgeProperties::weight, tn.g(), edesc) != edge_record->weight
+			|| tn.getEdgeIndex(edesc) != edge_record->index
+		) {
+			return false;
+		}
+		++edge_record;
+	}
+
+	return true;
+}
+
+::algo::Schedule Snapshot::makeSchedule(const TrackNetwork& tn) const {
+	if (!matches(tn)) {
+		::util::print_and_throw<std::invalid_argument>([&](auto&& err) {
+			err << "the snapshot's schedule was made for a different track network";
+		});
+	}
+
+	const auto& header = *getRecords<Header>(0);
+	const auto route_records = getRecords<RouteRecord>(header.routes.offset);
+	const auto path_vertices = getRecords<uint64_t>(header.path_vertices.offset);
+	const auto start_offsets = getRecords<int64_t>(header.start_offsets.offset);
+	const auto characters = getRecords<char>(header.characters.offset);
+
+	std::vector<::algo::TrainRoute> train_routes;
+	for (uint64_t i = 0; i != header.routes.count; ++i) {
+		const auto& record = route_records[i];
+		const auto path_begin = path_vertices + record.path_offset;
+		const auto start_offsets_begin = start_offsets + record.start_offsets_offset;
+		train_routes.emplace_back(
+			::util::make_id<::algo::RouteID>(record.route_id),
+			std::vector<TrackNetwork::NodeID>(path_begin, path_begin + record.path_length),
+			std::vector<TrackNetwork::Time>(start_offsets_begin, start_offsets_begin + record.start_offsets_length),
+			record.repeat_time,
+			tn
+		);
+	}
+
+	return ::algo::Schedule(
+		std::string(characters + header.schedule_name_offset, header.schedule_name_length),
+		std::move(train_routes)
+	);
+}
+
+} // end namespace snapshot
+} // end namespace parsing
@@ -0,0 +1,68 @@
+#ifndef PARSING__SNAPSHOT_H
+#define PARSING__SNAPSHOT_H
+
+#include <algo/scheduler.h++>
+#include <util/track_network.h++>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace parsing {
+namespace snapshot {
+
+/**
+ * Binary snapshots of a TrackNetwork, and a Schedule made for it, so that a
+ * schedule can be computed once and used by later runs. A file is a fixed
+ * header followed by flat arrays of fixed size records (see snapshot.c++),
+ * which are read straight out of a memory mapping, without any parsing.
+ * Files are only readable with the same FORMAT_VERSION, on machines with the
+ * same byte order.
+ */
+const uint32_t FORMAT_VERSION = 1;
+
+/**
+ * Write tn and sch (which must have been made for tn) to file_name.
+ * Throws std::runtime_error if the file can't be written.
+ */
+void save_snapshot(const std::string& file_name, const TrackNetwork& tn, const ::algo::Schedule& sch);
+
+/**
+ * A snapshot file, mapped into memory. The constructor throws std::runtime_error
+ * if the file can't be read, or isn't a valid snapshot of this FORMAT_VERSION.
+ */
+class Snapshot {
+public:
+	Snapshot(const std::string& file_name);
+	~Snapshot();
+
+	Snapshot(const Snapshot&) = delete;
+	Snapshot& operator=(const Snapshot&) = delete;
+
+	TrackNetwork makeTrackNetwork() const;
+
+	/**
+	 * Is tn the same as the network that this snapshot was made from?
+	 * Compares vertices, edges and all their properties, in order.
+	 */
+	bool matches(const TrackNetwork& tn) const;
+
+	/**
+	 * The schedule in this snapshot, made for tn. Throws std::invalid_argument
+	 * if tn doesn't match the network the schedule was saved with, as
+	 * the vertex IDs in the routes wouldn't mean the same thing.
+	 */
+	::algo::Schedule makeSchedule(const TrackNetwork& tn) const;
+
+private:
+	template<typename RECORD>
+	const RECORD* getRecords(uint64_t offset) const;
+
+	const char* mapping;
+	size_t mapping_size;
+};
+
+} // end namespace snapshot
+} // end namespace parsing
+
+#endif /* PARSING__SNAPSHOT_H */
@@ -2,9 +2,17 @@
 #include "simulator_internal.h++"
 
 #include <util/logging.h++>
+#include <util/metrics.h++>
+
+#include <cmath>
 
 namespace sim {
 
+namespace {
+	// how often to look through the route cache for routes that can't be used any more
+	const SimTime ROUTE_CACHE_TRIM_PERIOD = 100;
+}
+
 const TrainLocation& SimulatorHandle::getTrainLocation(const ::algo::TrainID& train) const { return get()->getTrainLocation(train ); }
 const PassengerIDSet& SimulatorHandle::getPassengerIDsAt(const ::algo::TrainID& train) const { return get()->getPassengerIDsAt(train  ); }
 const PassengerIDSet& SimulatorHandle::getPassengerIDsAt(const StationID& station    ) const { return get()->getPassengerIDsAt(station); }
@@ -22,12 +30,17 @@ std::shared_ptr<const TrackNetwork> SimulatorHandle::getTrackNetworkUsed() { ret
 void SimulatorHandle::registerObserver(ObserverType observer, SimTime period) { get()->registerObserver(observer, period); }
 bool SimulatorHandle::isPaused() { return get()->isPaused(); }
 
+void SimulatorHandle::registerPassengerExitObserver(PassengerExitObserverType observer) { get()->registerPassengerExitObserver(observer); }
+void SimulatorHandle::setKeepExitedPassengers(bool keep) { get()->setKeepExitedPassengers(keep); }
+size_t SimulatorHandle::getNumCachedRoutes() const { return get()->getNumCachedRoutes(); }
+
 SimulatorHandle instantiate_simulator(
 	const PassengerGeneratorFactory::PassengerGeneratorCollection* passenger_generators,
 	std::shared_ptr<const ::algo::Schedule> schedule,
-	std::shared_ptr<const TrackNetwork> tn
+	std::shared_ptr<const TrackNetwork> tn,
+	SimulationMode mode
 ) {
-	return SimulatorHandle(std::make_shared<Simulator>(passenger_generators, schedule, tn));
+	return SimulatorHandle(std::make_shared<Simulator>(passenger_generators, schedule, tn, mode));
 }
 
 Simulator::~Simulator() {
@@ -64,9 +77,14 @@ void Simulator::runForTime(const SimTime& time_to_run, const SimTime& max_step_s
 	const auto job_token = sim_task_controller.getJobToken();
 	if (sim_task_controller.isCancelRequested()) { return; }
 
+	metrics::ScopedTimer timer(metrics::Phase::SIMULATE);
+
 	const auto stop_time = current_time + time_to_run;
 
-	auto last_observer_update_time = current_time;
+	if (mode == SimulationMode::EVENT_DRIVEN) {
+		processEventsUntil(stop_time);
+		return;
+	}
 
 	while (true) {
 		if (sim_task_controller.isCancelRequested()) { return; }
@@ -78,15 +96,7 @@ void Simulator::runForTime(const SimTime& time_to_run, const SimTime& max_step_s
 		}
 
 		const auto next_step_time = current_time + std::min(time_left, max_step_size);
-		const auto next_observer_update_time = (
-			observers_and_periods.empty()
-		) ? (
-			// if no observers, just use max
-			std::numeric_limits<SimTime>::max()
-		) : (
-			// else, try to advance by shortest observer period (list is sorted)
-			last_observer_update_time + observers_and_periods.front().second
-		);
+		const auto next_observer_update_time = getNextObserverTime();
 
 		enum class WhichTime {
 			STEP, OBSERVER,
@@ -101,6 +111,7 @@ void Simulator::runForTime(const SimTime& time_to_run, const SimTime& max_step_s
 
 		auto time_advavced = advanceUntilEvent(sim_until_time);
 		(void)time_advavced;
+		metrics::count(metrics::Counter::SIM_STEPS);
 
 		setIsPaused(true);
 
@@ -110,48 +121,283 @@ void Simulator::runForTime(const SimTime& time_to_run, const SimTime& max_step_s
 
 		// call the observers
 		if (sim_until_time_compare_results.id() == WhichTime::OBSERVER) {
-			last_observer_update_time = current_time;
-			dout(DL::SIM_D1) << "calling the " << observers_and_periods.size() << " observers\n";
+			last_observer_time = current_time;
+			callObservers();
+		}
+	}
+}
 
-			for (auto it = observers_and_periods.begin(); it != observers_and_periods.end();) {
+/**
+ * When the observers should next be called: the shortest observer period (the list
+ * is sorted) after they were last called, or now, if that has already gone by.
+ */
+SimTime Simulator::getNextObserverTime() const {
+	if (observers_and_periods.empty()) {
+		return std::numeric_limits<SimTime>::max();
+	}
+	return std::max(current_time, last_observer_time + observers_and_periods.front().second);
+}
 
-				bool result = it->first(); // execute observer
+void Simulator::callObservers() {
+	dout(DL::SIM_D1) << "calling the " << observers_and_periods.size() << " observers\n";
 
-				// 'it' will get invalidated by the erase, so increment past it first
-				const auto it_copy = it;
-				++it;
+	for (auto it = observers_and_periods.begin(); it != observers_and_periods.end();) {
 
-				if (result == false) {
-					// remove if return false
-					observers_and_periods.erase(it_copy);
-				}
-			}
+		bool result = it->first(); // execute observer
+
+		// 'it' will get invalidated by the erase, so increment past it first
+		const auto it_copy = it;
+		++it;
 
+		if (result == false) {
+			// remove if return false
+			observers_and_periods.erase(it_copy);
 		}
 	}
 }
 
-SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
-	dout(DL::SIM_D2) << "Simulating t:" << current_time << " -> " << sim_until_time << '\n';
+void Simulator::processEventsUntil(const SimTime& stop_time) {
+	dout(DL::SIM_D2) << "Simulating events t:" << current_time << " -> " << stop_time << '\n';
 
-	if (sim_until_time < current_time) {
+	if (stop_time < current_time) {
 		::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
-			str << "trying to simulate backwards! t1=" << current_time << ", t2=" << sim_until_time << '\n';
+			str << "trying to simulate backwards! t1=" << current_time << ", t2=" << stop_time << '\n';
 		});
 	}
 
-	// remove passengers that are at the destinations
-	for (const auto& station_id : tn->getStaitonRange()) {
-		auto& p_list = passengers_at_stations.at(station_id.getValue());
+	if (!event_queue_initialized) {
+		initializeEventQueue();
+	}
 
-		util::remove_if_assoc(p_list, [&](const auto& pid) {
-			const auto& p = passenger_list.at(pid);
-			if (getRouteFor(p).back().getLocation() == station_id) {
-				dout(DL::SIM_D3) << "passenger " << p.getName() << " left the system at it's destination, " << station_id << '\n';
-				return true;
-			} else {
-				return false;
+	setIsPaused(false);
+
+	while (!event_queue.empty() && event_queue.top().time < stop_time) {
+		if (sim_task_controller.isCancelRequested()) {
+			setIsPaused(true);
+			return;
+		}
+
+		const auto event = event_queue.top();
+		event_queue.pop();
+		current_time = event.time;
+		metrics::count(metrics::Counter::SIM_EVENTS);
+
+		switch (event.type) {
+			case Event::Type::PASSENGER_SPAWN:
+				handlePassengerSpawn(event);
+				break;
+			case Event::Type::TRAIN_DEPARTURE:
+				handleTrainDeparture(event);
+				break;
+			case Event::Type::TRAIN_ARRIVAL:
+				handleTrainArrival(event.train, event.index);
+				break;
+			case Event::Type::OBSERVERS:
+				handleObservers(event);
+				break;
+		}
+	}
+
+	current_time = stop_time;
+	updateTrainLocationFractions();
+
+	setIsPaused(true);
+}
+
+void Simulator::initializeEventQueue() {
+	event_queue_initialized = true;
+
+	// trains of a route with the same start offset leave one repeat time apart, so
+	// only the next one for each start offset needs to be in the queue at any time
+	for (const auto& route : schedule->getTrainRoutes()) {
+		const auto& start_offsets = route.getStartOffsets();
+		for (::algo::TrainIndex offset_index = 0; offset_index != start_offsets.size(); ++offset_index) {
+			::algo::TrainIndex repeat_number = 0;
+			if (start_offsets[offset_index] < current_time && route.getRepeatTime() > 0) {
+				repeat_number = std::ceil((current_time - start_offsets[offset_index]) / route.getRepeatTime());
 			}
+			const auto train_index = repeat_number*start_offsets.size() + offset_index;
+			const auto departure_time = timetable.getDepartureTime(route.getID(), train_index);
+			if (departure_time >= current_time) {
+				event_queue.push(Event{static_cast<SimTime>(departure_time), Event::Type::TRAIN_DEPARTURE, ::util::make_id<::algo::TrainID>(route.getID(), train_index), 0});
+			}
+		}
+	}
+
+	for (uint32_t generator_index = 0; generator_index != passenger_generators.size(); ++generator_index) {
+		const auto first_time = passenger_departures[generator_index].firstPassengerAtOrAfter(current_time);
+		if (first_time != std::numeric_limits<decltype(first_time)>::max()) {
+			event_queue.push(Event{static_cast<SimTime>(first_time), Event::Type::PASSENGER_SPAWN, ::algo::TrainID(), generator_index});
+		}
+	}
+
+	scheduleObservers();
+}
+
+void Simulator::handlePassengerSpawn(const Event& event) {
+	const auto& p_gen = passenger_generators.at(event.index);
+	const auto spawn_time = static_cast<TrackNetwork::Time>(event.time);
+	const auto p = p_gen.instantiateAt(passenger_id_generator.gen_id(), spawn_time);
+	const auto pid = p.getID();
+
+	dout(DL::SIM_D3) << "adding passenger " << p << '\n';
+	passenger_list.emplace(pid, p);
+	passengers_at_stations.at(p.getEntryID()).emplace(pid);
+	passenger_paths[pid].emplace_back(getRouteFor(p).front()); // add start RE
+	enqueueForNextTrain(pid, tn->getStationIDByVertexID(p.getEntryID()));
+
+	const auto next_time = passenger_departures.at(event.index).nextPassengerAfter(spawn_time);
+	if (next_time != std::numeric_limits<decltype(next_time)>::max()) {
+		event_queue.push(Event{static_cast<SimTime>(next_time), Event::Type::PASSENGER_SPAWN, ::algo::TrainID(), event.index});
+	}
+}
+
+void Simulator::handleTrainDeparture(const Event& event) {
+	const auto& route = schedule->getTrainRoute(event.train.getRouteID());
+
+	dout(DL::SIM_D3) << "adding train " << event.train << ", departs at t=" << current_time << '\n';
+	train_locations.emplace(event.train, TrainLocation());
+
+	// queue the next train with the same start offset
+	if (route.getRepeatTime() > 0) {
+		const auto next_train_index = event.train.getTrainIndex() + route.getStartOffsets().size();
+		event_queue.push(Event{
+			static_cast<SimTime>(timetable.getDepartureTime(route.getID(), next_train_index)),
+			Event::Type::TRAIN_DEPARTURE,
+			::util::make_id<::algo::TrainID>(route.getID(), next_train_index),
+			0
+		});
+	}
+
+	handleTrainArrival(event.train, timetable.getFirstStopOf(route.getID()));
+}
+
+void Simulator::handleTrainArrival(const ::algo::TrainID& train_id, ::algo::Timetable::StopIndex stop) {
+	const auto& station_id = tn->getStationIDByVertexID(timetable.getVertexOf(stop));
+	const auto train_indent = dout(DL::SIM_D3).indentWithTitle([&](auto&& str) {
+		str << "Train " << train_id << " at " << tn->getVertexName(station_id.getValue()) << " t=" << current_time;
+	});
+
+	train_locations.at(train_id) = TrainLocation(stop - timetable.getFirstStopOf(train_id.getRouteID()), 0);
+
+	// pickup passengers
+	auto& waiting_at_station = boarding_queues.at(station_id.getValue());
+	const auto waiting_find_results = waiting_at_station.find(train_id);
+	if (waiting_find_results != waiting_at_station.end()) {
+		auto& getting_off_this_train = alighting_queues[train_id];
+		for (const auto& pid : waiting_find_results->second) {
+			movePassengerFromHereGoingTo(pid, station_id, train_id, current_time);
+			const auto& alight_element = getRouteFor(pid).at(passenger_paths.at(pid).size());
+			getting_off_this_train[alight_element.getLocation().asStationID().getValue()].push_back(pid);
+		}
+		waiting_at_station.erase(waiting_find_results);
+	}
+
+	// and drop off passengers
+	const auto getting_off_find_results = alighting_queues.find(train_id);
+	if (getting_off_find_results != alighting_queues.end()) {
+		auto& getting_off_this_train = getting_off_find_results->second;
+		const auto getting_off_here = getting_off_this_train.find(station_id.getValue());
+		if (getting_off_here != getting_off_this_train.end()) {
+			for (const auto& pid : getting_off_here->second) {
+				movePassengerFromHereGoingTo(pid, train_id, station_id, current_time);
+				enqueueForNextTrain(pid, station_id);
+			}
+			getting_off_this_train.erase(getting_off_here);
+		}
+	}
+
+	const auto next_stop = timetable.getNextStop(stop);
+	if (next_stop == ::algo::Timetable::INVALID_STOP) {
+		if (passengers_on_trains[train_id].empty() == false) {
+			::util::print_and_throw<std::runtime_error>([&](auto&& str) {
+				str << " train " << train_id << " had the passengers ";
+				util::print_container(passengers_on_trains[train_id], str);
+				str << " when it exited!\n";
+			});
+		}
+		dout(DL::SIM_D3) << "destination reached\n";
+		train_locations.erase(train_id);
+		passengers_on_trains.erase(train_id);
+		alighting_queues.erase(train_id);
+	} else {
+		event_queue.push(Event{
+			static_cast<SimTime>(timetable.getArrivalTime(next_stop, train_id.getTrainIndex())),
+			Event::Type::TRAIN_ARRIVAL,
+			train_id,
+			next_stop
+		});
+	}
+}
+
+void Simulator::handleObservers(const Event& event) {
+	if (event.time != next_observer_event_time) {
+		return; // replaced by a later scheduleObservers
+	}
+
+	updateTrainLocationFractions();
+	setIsPaused(true);
+	callObservers();
+	setIsPaused(false);
+
+	last_observer_time = current_time;
+	scheduleObservers();
+}
+
+void Simulator::scheduleObservers() {
+	next_observer_event_time = getNextObserverTime();
+	if (next_observer_event_time == std::numeric_limits<SimTime>::max()) {
+		return;
+	}
+
+	event_queue.push(Event{next_observer_event_time, Event::Type::OBSERVERS, ::algo::TrainID(), 0});
+}
+
+/**
+ * Puts the passenger in line for the next train in it's route, or if there are no
+ * more trains, removes it from the station.
+ */
+void Simulator::enqueueForNextTrain(const PassengerID& passenger_id, const StationID& station_id) {
+	const auto& route = getRouteFor(passenger_id);
+	const auto next_element_index = passenger_paths.at(passenger_id).size();
+
+	if (next_element_index >= route.size()) {
+		dout(DL::SIM_D3) << "passenger " << passenger_list.at(passenger_id).getName() << " left the system at it's destination, " << station_id << '\n';
+		passengers_at_stations.at(station_id.getValue()).erase(passenger_id);
+		handlePassengerLeft(passenger_id);
+	} else {
+		boarding_queues.at(station_id.getValue())[route[next_element_index].getLocation().asTrainID()].push_back(passenger_id);
+	}
+}
+
+/**
+ * Trains' edge_number is kept up to date as they arrive at stations, but the
+ * fraction is only calculated when someone could look at it.
+ */
+void Simulator::updateTrainLocationFractions() {
+	for (auto& [train_id, location] : train_locations) {
+		const auto stop = timetable.getFirstStopOf(train_id.getRouteID()) + location.edge_number;
+		const auto next_stop = timetable.getNextStop(stop);
+		if (next_stop == ::algo::Timetable::INVALID_STOP) {
+			continue;
+		}
+
+		const SimTime leave_time = timetable.getArrivalTime(stop, train_id.getTrainIndex());
+		const SimTime arrive_time = timetable.getArrivalTime(next_stop, train_id.getTrainIndex());
+		if (arrive_time > leave_time) {
+			location.fraction_through_edge = std::min(1.0, std::max(0.0,
+				(current_time - leave_time) / (arrive_time - leave_time)
+			));
+		}
+	}
+}
+
+SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
+	dout(DL::SIM_D2) << "Simulating t:" << current_time << " -> " << sim_until_time << '\n';
+
+	if (sim_until_time < current_time) {
+		::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
+			str << "trying to simulate backwards! t1=" << current_time << ", t2=" << sim_until_time << '\n';
 		});
 	}
 
@@ -179,11 +425,17 @@ SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
 	// }
 
 	// inject passengers
-	for (const auto& p_gen : passenger_generators) {
-		for (auto&& p : p_gen.leavingDuringInterval(current_time, sim_until_time, passenger_id_generator)) {
+	for (size_t generator_index = 0; generator_index != passenger_generators.size(); ++generator_index) {
+		auto& departures = passenger_departures[generator_index];
+		for (
+			auto spawn_time = departures.firstPassengerAtOrAfter(current_time);
+			spawn_time < sim_until_time;
+			spawn_time = departures.nextPassengerAfter(spawn_time)
+		) {
+			const auto p = passenger_generators[generator_index].instantiateAt(passenger_id_generator.gen_id(), spawn_time);
 			dout(DL::SIM_D3) << "adding passenger " << p << '\n';
 			const auto pid = p.getID();
-			passenger_list.emplace(pid,std::move(p));
+			passenger_list.emplace(pid,p);
 			passengers_at_stations.at(p.getEntryID()).emplace(pid);
 			passenger_paths[pid].emplace_back(getRouteFor(p).front()); // add start RE
 		}
@@ -201,16 +453,12 @@ SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
 		const auto& train = route.makeTrainFromIndex(trainID.getTrainIndex());
 		auto& position_info = value_pair.second;
 
-		SimTime time_until_prev_vertex = 0;
-
 		const auto train_indent = dout(DL::SIM_D3).indentWithTitle([&](auto&& str) {
 			str << "Updating Train " << train;
 		});
 
 		// handle trains that are starting in the simulated interval
-		const auto time_to_departure_from_interval_start = train.getDepartureTime() - current_time;
-
-		if (sim_until_time < time_to_departure_from_interval_start) {
+		if (sim_until_time <= train.getDepartureTime()) {
 			::util::print_and_throw<std::runtime_error>([&](auto&& str) {
 				str << "train " << train << " departs in the future!\n";
 			});
@@ -219,47 +467,46 @@ SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
 		if (
 			position_info.edge_number == 0 &&
 			position_info.fraction_through_edge == 0 &&
-			time_to_departure_from_interval_start < 0
+			train.getDepartureTime() < current_time
 		) {
 			::util::print_and_throw<std::runtime_error>([&](auto&& str) {
 				str << "train " << train << " departed in the past!\n";
 			});
 		}
 
-		// create a constant subtraction, if this train starts in the future
-		const auto departing_subtraction = time_to_departure_from_interval_start > 0 ? time_to_departure_from_interval_start : 0;
-
-		// figure out which edge the train should be on, and update position_info
-		auto prev_vertex_it = route.getPath().begin() + position_info.edge_number;
-		auto next_vertex_it = prev_vertex_it + 1;
+		// figure out which edge the train should be on, and update position_info.
+		// Times come from the timetable, so they are the same whatever the step size is
+		auto prev_stop = timetable.getFirstStopOf(routeID) + position_info.edge_number;
 
 		while (true) {
 			dout(DL::SIM_D3) << "current position: e#=" << position_info.edge_number << ", fte=" << position_info.fraction_through_edge << '\n';
 
-			const auto current_time_in_simulation_of_this_train =
-				current_time + time_until_prev_vertex - departing_subtraction
-			;
+			const SimTime time_at_prev_vertex = timetable.getArrivalTime(prev_stop, trainID.getTrainIndex());
 
 			if (position_info.fraction_through_edge == 0) {
-				const auto& arriving_station_id = tn->getStationIDByVertexID(*prev_vertex_it);
+				const auto& arriving_station_id = tn->getStationIDByVertexID(timetable.getVertexOf(prev_stop));
 
-				// make copies, so that if the loops modify (which they do) then nothing confusing happens
-				// this isn't very efficient, but it's the most straightforward...
-				const auto old_passengers_at_the_station = passengers_at_stations.at(arriving_station_id.getValue());
-				const auto old_passengers_on_this_train = passengers_on_trains[trainID];
+				// Moving a passenger only takes it out of the set being looped over, so step past
+				// it first, instead of copying the set. Like EVENT_DRIVEN, passengers are picked up,
+				// then dropped off, so ones dropped off here can't get back on.
+				auto& at_the_station = passengers_at_stations.at(arriving_station_id.getValue());
+				auto& on_this_train = passengers_on_trains[trainID];
 
 				// pickup passengers
-				for (const auto& p : old_passengers_at_the_station) {
-					movePassengerFromHereGoingTo(p, arriving_station_id, trainID, current_time_in_simulation_of_this_train);
+				for (auto it = at_the_station.begin(); it != at_the_station.end(); ) {
+					const auto p = *(it++);
+					movePassengerFromHereGoingTo(p, arriving_station_id, trainID, time_at_prev_vertex);
 				}
 
 				// and drop off passengers
-				for (const auto& p : old_passengers_on_this_train) {
-					movePassengerFromHereGoingTo(p, trainID, arriving_station_id, current_time_in_simulation_of_this_train);
+				for (auto it = on_this_train.begin(); it != on_this_train.end(); ) {
+					const auto p = *(it++);
+					movePassengerFromHereGoingTo(p, trainID, arriving_station_id, time_at_prev_vertex);
 				}
 			}
 
-			if (next_vertex_it == route.getPath().end()) {
+			const auto next_stop = timetable.getNextStop(prev_stop);
+			if (next_stop == ::algo::Timetable::INVALID_STOP) {
 				// ie. if the "prev" vertex is the last one.
 				if (passengers_on_trains[trainID].empty() == false) {
 					::util::print_and_throw<std::runtime_error>([&](auto&& str) {
@@ -273,38 +520,15 @@ SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
 				break;
 			}
 
-			const auto time_left_to_simulate =
-				sim_until_time - current_time_in_simulation_of_this_train;
-			;
-
-			if (time_left_to_simulate <= 0) {
-				break;
-			}
+			const SimTime time_at_next_vertex = timetable.getArrivalTime(next_stop, trainID.getTrainIndex());
 
-			const auto fraction_left_to_travel = 1 - position_info.fraction_through_edge;
-
-			using std::next;
-			// calculate the time it would take to get to the next vertex
-			const auto additional_time_to_next_vertex = (
-				(
-					fraction_left_to_travel
-				) * (
-					train.getExpectedTravelTime(
-						{prev_vertex_it, next(next_vertex_it)}, *tn
-					)
-				)
-			);
-
-			// the next vertex would be too far, so it's currently on this edge
-			if (additional_time_to_next_vertex > time_left_to_simulate) {
-				position_info.fraction_through_edge += (
-					(
-						fraction_left_to_travel
-					) * (
-						time_left_to_simulate
-					) / (
-						additional_time_to_next_vertex
-					)
+			// the next vertex is at or after the end of this step, so it's currently on this edge.
+			// Arriving right at the end is left for the next step, after its passengers have spawned
+			if (time_at_next_vertex >= sim_until_time) {
+				position_info.fraction_through_edge = (
+					sim_until_time - time_at_prev_vertex
+				) / (
+					time_at_next_vertex - time_at_prev_vertex
 				);
 				if (!(0 <= position_info.fraction_through_edge && position_info.fraction_through_edge <= 1)) {
 					::util::print_and_throw<std::runtime_error>([&](auto&& str) {
@@ -315,22 +539,40 @@ SimTime Simulator::advanceUntilEvent(const SimTime& sim_until_time) {
 			}
 
 			// if we get here, the train will be just about to arrive at the "next" station
-			dout(DL::SIM_D2) << "train " << train << " just about to arrive at " << tn->getVertexName(*next_vertex_it) << '\n';
+			dout(DL::SIM_D2) << "train " << train << " just about to arrive at " << tn->getVertexName(timetable.getVertexOf(next_stop)) << '\n';
 
 			// "just arrive" at station, by making previous what the next was
-			prev_vertex_it = next_vertex_it;
-			++next_vertex_it;
+			prev_stop = next_stop;
 			++position_info.edge_number;
 			position_info.fraction_through_edge = 0;
-			time_until_prev_vertex += additional_time_to_next_vertex;
 		}
 	}
-
 	// remove marked trains
 	for (const auto& tid : trains_to_remove) {
 		train_locations.erase(tid);
 	}
 
+	// remove passengers that are at their destinations, including any that started there,
+	// so none are left in the system at the end of the step (as in EVENT_DRIVEN)
+	std::vector<PassengerID> exited_passengers;
+	for (const auto& station_id : tn->getStaitonRange()) {
+		auto& p_list = passengers_at_stations.at(station_id.getValue());
+
+		util::remove_if_assoc(p_list, [&](const auto& pid) {
+			const auto& p = passenger_list.at(pid);
+			if (getRouteFor(p).back().getLocation() == station_id) {
+				dout(DL::SIM_D3) << "passenger " << p.getName() << " left the system at it's destination, " << station_id << '\n';
+				exited_passengers.push_back(pid);
+				return true;
+			} else {
+				return false;
+			}
+		});
+	}
+	for (const auto& pid : exited_passengers) {
+		handlePassengerLeft(pid);
+	}
+
 	// update time
 	current_time = sim_until_time;
 
@@ -347,7 +589,7 @@ void Simulator::movePassengerFromHereGoingTo(
 	const LocationID& to_location,
 	const SimTime& time_of_move
 ) {
-	const auto route = getRouteFor(passenger_id);
+	const auto& route = getRouteFor(passenger_id);
 
 	// find the next route element
 	const auto next_route_element_it = [&]() {
@@ -435,19 +677,66 @@ void Simulator::movePassengerFromHereGoingTo(
 	}
 
 	passenger_paths[passenger_id].emplace_back(to_location, time_of_move);
+	metrics::count(metrics::Counter::PASSENGERS_MOVED);
 
 	if (next_location == tn->getStationIDByVertexID(passenger_list.at(passenger_id).getExitID())) {
 		// mark as exited
-		passenger_histories.emplace(passenger_id, PassengerExitInfo{time_of_move, passenger_paths.at(passenger_id)});
+		const auto& path = passenger_paths.at(passenger_id);
+		for (const auto& observer : passenger_exit_observers) {
+			observer(passenger_list.at(passenger_id), time_of_move, path);
+		}
+		if (keep_exited_passengers) {
+			passenger_histories.emplace(passenger_id, PassengerExitInfo{time_of_move, path});
+		}
 	}
 }
 
+/**
+ * Called once a passenger is no longer at any location. Unless they are being
+ * kept for later, nothing will look at them again.
+ */
+void Simulator::handlePassengerLeft(const PassengerID& passenger_id) {
+	const auto& path = passenger_paths.at(passenger_id);
+
+	// passengers that started at their exit never moved, so haven't been seen exiting yet
+	if (path.size() < 2) {
+		for (const auto& observer : passenger_exit_observers) {
+			observer(passenger_list.at(passenger_id), path.back().getTime(), path);
+		}
+	}
+
+	if (keep_exited_passengers) {
+		return;
+	}
+	passenger_routes.removeRoute(passenger_list.at(passenger_id));
+	passenger_paths.erase(passenger_id);
+	passenger_list.erase(passenger_id);
+}
+
+/**
+ * If the passenger has got to it's exit, and so has been given to the passenger
+ * exit observers. It might still be in the passenger list, if they are being kept.
+ */
+bool Simulator::hasExited(const PassengerID& passenger_id) const {
+	const auto& path = passenger_paths.at(passenger_id);
+	return path.back().getLocation() == tn->getStationIDByVertexID(passenger_list.at(passenger_id).getExitID());
+}
+
 void Simulator::registerObserver(ObserverType observer, SimTime period) {
 	const auto prev_iter = std::find_if(observers_and_periods.begin(), observers_and_periods.end(), [&](const auto& elem) {
 		return elem.second < period;
 	});
 	observers_and_periods.emplace(prev_iter, std::make_pair(observer, period));
 	dout(DL::SIM_D1) << "added observer, period=" << period << '\n';
+
+	if (mode == SimulationMode::EVENT_DRIVEN && event_queue_initialized) {
+		scheduleObservers();
+	}
+}
+
+void Simulator::registerPassengerExitObserver(PassengerExitObserverType observer) {
+	passenger_exit_observers.push_back(observer);
+	dout(DL::SIM_D1) << "added passenger exit observer\n";
 }
 
 const algo::PassengerRoutes::RouteType& Simulator::getRouteFor(PassengerID pid) {
@@ -456,18 +745,25 @@ const algo::PassengerRoutes::RouteType& Simulator::getRouteFor(PassengerID pid)
 
 const algo::PassengerRoutes::RouteType& Simulator::getRouteFor(const Passenger& p) {
 	if (passenger_routes.hasRoute(p) == false) {
+		// passengers from now on start no earlier than now, so older routes won't be used
+		if (current_time >= next_route_cache_trim_time) {
+			algo::forget_cached_routes_before(route_cache_handle, static_cast<TrackNetwork::Time>(std::floor(current_time)));
+			next_route_cache_trim_time = current_time + ROUTE_CACHE_TRIM_PERIOD;
+		}
+
 		const auto& indent = dout(DL::SIM_D3).indentWithTitle([&](auto&& str) {
 			str << "re-routing passenger " << p;
 		});
-		const auto& [route, ch] = algo::route_through_schedule(
+		algo::PassengerRoutes::RouteType route;
+		std::tie(route, route_cache_handle) = algo::route_through_schedule(
 			*tn,
 			*schedule,
 			p.getStartTime(),
 			p.getEntryID(),
-			p.getExitID()
+			p.getExitID(),
+			std::move(route_cache_handle)
 		);
-		passenger_routes.addRoute(p, route);
-		(void)ch; // TODO do something with the cache handle
+		passenger_routes.addRoute(p, std::move(route));
 	}
 	return passenger_routes.getRoute(p);
 }
@@ -2,6 +2,7 @@
 #ifndef SIM__SIMULATOR_HPP
 #define SIM__SIMULATOR_HPP
 
+#include <algo/passenger_routing.h++>
 #include <algo/scheduler.h++>
 #include <util/handles.h++>
 #include <util/passenger_generator.h++>
@@ -36,6 +37,30 @@ using PassengerList = std::unordered_map<PassengerID, Passenger>;
 
 using ObserverType = std::function<bool()>;
 
+/**
+ * Called as each passenger gets to its exit, with the time it got there, and
+ * where it was (and when) from its entry up to and including its exit.
+ * Passengers that start at their exit are given a path of just their entry.
+ */
+using PassengerExitObserverType = std::function<void(
+	const Passenger& passenger,
+	const SimTime& time_of_exit,
+	const ::algo::PassengerRoutes::RouteType& path
+)>;
+
+/**
+ * FIXED_STEP moves everything forward by (at most) the step size passed to runForTime,
+ * looking at every station, train and passenger generator each step.
+ * EVENT_DRIVEN keeps a queue of train arrivals & departures, passenger spawns
+ * and observer calls, and jumps from one to the next. The step size is ignored.
+ * Both take train times from the timetable, and only handle what happens before
+ * the end of runForTime's interval, so the passengers' histories are the same.
+ */
+enum class SimulationMode {
+	FIXED_STEP,
+	EVENT_DRIVEN,
+};
+
 class SimulatorHandle : public ::util::shared_handle<Simulator> {
 public:
 	using shared_handle::shared_handle;
@@ -88,13 +113,32 @@ public:
 	void registerObserver(ObserverType observer, SimTime period);
 	bool isPaused();
 
+	void registerPassengerExitObserver(PassengerExitObserverType observer);
+
+	/**
+	 * Keep passengers (their routes, paths and exit time) after they exit. On by default.
+	 * If off, they are forgotten once they leave the system, after the exit observers
+	 * have seen them, so memory use doesn't grow with the time simulated. The passenger
+	 * list then only has the passengers still in the system, so use exit observers
+	 * for anything to do with passengers that have finished.
+	 */
+	void setKeepExitedPassengers(bool keep);
+
+	/**
+	 * How many routes are in the cache shared by the passengers' route searches.
+	 * Routes too early to be used again are forgotten, so this doesn't grow with
+	 * the time simulated either.
+	 */
+	size_t getNumCachedRoutes() const;
+
 private:
 	const Train2PositionInfoMap& getTrainLocations() const;
 
 	friend SimulatorHandle instantiate_simulator(
 		const PassengerGeneratorFactory::PassengerGeneratorCollection* passenger_generators,
 		std::shared_ptr<const ::algo::Schedule> schedule,
-		std::shared_ptr<const TrackNetwork> tn
+		std::shared_ptr<const TrackNetwork> tn,
+		SimulationMode mode
 	);
 	friend class Simulator;
 };
@@ -102,7 +146,8 @@ private:
 SimulatorHandle instantiate_simulator(
 	const PassengerGeneratorFactory::PassengerGeneratorCollection* passenger_generators,
 	std::shared_ptr<const ::algo::Schedule> schedule,
-	std::shared_ptr<const TrackNetwork> tn
+	std::shared_ptr<const TrackNetwork> tn,
+	SimulationMode mode = SimulationMode::EVENT_DRIVEN
 );
 
 } // end namespace sim
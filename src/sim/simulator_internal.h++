@@ -2,10 +2,15 @@
 #include "simulator.h++"
 
 #include <algo/passenger_routing.h++>
+#include <algo/timetable.h++>
 #include <util/thread_utils.h++>
 
+#include <limits>
 #include <list>
 #include <mutex>
+#include <queue>
+#include <tuple>
+#include <vector>
 
 namespace sim {
 
@@ -14,14 +19,28 @@ public:
 	Simulator(
 		const PassengerGeneratorFactory::PassengerGeneratorCollection* passenger_generators,
 		std::shared_ptr<const ::algo::Schedule> schedule,
-		std::shared_ptr<const TrackNetwork> tn
+		std::shared_ptr<const TrackNetwork> tn,
+		SimulationMode mode
 	)
 	: passenger_generators(*passenger_generators)
+	, passenger_departures()
 	, schedule(schedule)
 	, tn(tn)
+	, mode(mode)
+	, timetable(*schedule, *tn)
 	, observers_and_periods()
+	, passenger_exit_observers()
+	, keep_exited_passengers(true)
 	, current_time()
+	, last_observer_time(0)
+	, event_queue()
+	, event_queue_initialized(false)
+	, next_observer_event_time(std::numeric_limits<SimTime>::max())
+	, boarding_queues(tn->makeStationMap<::algo::TrainMap<PassengerIDList>>())
+	, alighting_queues()
 	, passenger_routes()
+	, route_cache_handle()
+	, next_route_cache_trim_time(0)
 	, passenger_list()
 	, passengers_on_trains()
 	, passengers_at_stations(tn->makeStationMap<PassengerIDSet>())
@@ -32,7 +51,11 @@ public:
 	, is_paused(true)
 	, is_paused_mutex()
 	, sim_task_controller()
-	{ }
+	{
+		for (const auto& p_gen : *passenger_generators) {
+			passenger_departures.push_back(p_gen.makeDepartureCursor());
+		}
+	}
 
 	Simulator(const Simulator&) = delete;
 	Simulator(Simulator&&) = delete;
@@ -50,6 +73,7 @@ public:
 
 	void runForTime(const SimTime& time_to_run, const SimTime& max_step_size);
 	SimTime advanceUntilEvent(const SimTime& sim_until_time);
+	void processEventsUntil(const SimTime& stop_time);
 	SimTime getCurrentTime() { return current_time; }
 
 	void movePassengerFromHereGoingTo(
@@ -63,27 +87,83 @@ public:
 	const std::shared_ptr<const TrackNetwork> getTrackNetworkUsed() const { return tn; }
 
 	void registerObserver(ObserverType observer, SimTime period);
+	void registerPassengerExitObserver(PassengerExitObserverType observer);
+	void setKeepExitedPassengers(bool keep) { keep_exited_passengers = keep; }
 	bool isPaused() { std::unique_lock<std::recursive_mutex> paused_ul(is_paused_mutex); return is_paused; }
 	void setIsPaused(bool val) { std::unique_lock<std::recursive_mutex> paused_ul(is_paused_mutex); is_paused = val; }
 
 	// internal methods
 
 	const auto& getPassengerHistories() const { return passenger_histories; }
+	const ::algo::PassengerRoutes& getPassengerRoutes() const { return passenger_routes; }
+	bool hasExited(const PassengerID& passenger_id) const;
+	size_t getNumCachedRoutes() const { return ::algo::get_num_cached_routes(route_cache_handle); }
 
 	// to be move to a CachingPassengerRouter (or something)
 	const algo::PassengerRoutes::RouteType& getRouteFor(PassengerID pid);
 	const algo::PassengerRoutes::RouteType& getRouteFor(const Passenger& p);
 
 private:
+	/**
+	 * Something that will happen at a point in time. Events at the same time
+	 * are handled in the order of their Type, so passengers are at the station
+	 * before trains come, and observers see everything that happened.
+	 */
+	struct Event {
+		enum class Type {
+			PASSENGER_SPAWN, // index is the generator
+			TRAIN_DEPARTURE, // train is the train
+			TRAIN_ARRIVAL,   // train is the train, index is the StopIndex
+			OBSERVERS,
+		};
+
+		SimTime time;
+		Type type;
+		::algo::TrainID train;
+		uint32_t index;
+
+		bool operator>(const Event& rhs) const {
+			return std::make_tuple(time, type, train.getValue(), index)
+				> std::make_tuple(rhs.time, rhs.type, rhs.train.getValue(), rhs.index);
+		}
+	};
+
+	void initializeEventQueue();
+	void handlePassengerSpawn(const Event& event);
+	void handleTrainDeparture(const Event& event);
+	void handleTrainArrival(const ::algo::TrainID& train_id, ::algo::Timetable::StopIndex stop);
+	void handleObservers(const Event& event);
+	void scheduleObservers();
+	void enqueueForNextTrain(const PassengerID& passenger_id, const StationID& station_id);
+	void updateTrainLocationFractions();
+	SimTime getNextObserverTime() const;
+	void callObservers();
+	void handlePassengerLeft(const PassengerID& passenger_id);
+
 	const PassengerGeneratorFactory::PassengerGeneratorCollection& passenger_generators;
+	std::vector<PassengerGenerator::DepartureCursor> passenger_departures; // one for each generator, so spawning doesn't replay them from time 0
 	std::shared_ptr<const ::algo::Schedule> schedule;
 	std::shared_ptr<const TrackNetwork> tn;
+	const SimulationMode mode;
+	const ::algo::Timetable timetable;
 
 	std::list<std::pair<ObserverType, SimTime>> observers_and_periods;
+	std::vector<PassengerExitObserverType> passenger_exit_observers;
+	bool keep_exited_passengers;
 
 	SimTime current_time;
+	SimTime last_observer_time; // observer periods count from here, in both modes
+
+	// EVENT_DRIVEN only
+	std::priority_queue<Event, std::vector<Event>, std::greater<Event>> event_queue;
+	bool event_queue_initialized;
+	SimTime next_observer_event_time; // OBSERVERS events for other times are stale
+	StationMap<::algo::TrainMap<PassengerIDList>> boarding_queues; // passengers waiting for each train
+	::algo::TrainMap<std::unordered_map<TrackNetwork::NodeID, PassengerIDList>> alighting_queues; // passengers getting off at each station
 
 	::algo::PassengerRoutes passenger_routes; // to ba part of CachingPassengerRouter
+	::algo::RouteTroughScheduleCacheHandle route_cache_handle; // so passengers with the same entry & exit share searches
+	SimTime next_route_cache_trim_time; // when to next forget the cached routes that are too early to be used again
 
 	PassengerList passenger_list;
 	::algo::TrainMap<PassengerIDSet> passengers_on_trains;
@@ -0,0 +1,142 @@
+#include "replication_stats.h++"
+
+#include <sim/simulator_internal.h++>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+
+namespace stats {
+
+RunSummary summarize_run(const ::sim::SimulatorHandle& sim_handle) {
+	const auto& passenger_histories = sim_handle.get()->getPassengerHistories();
+
+	RunSummary result;
+	result.num_passengers_entered = sim_handle.getPassengerList().size();
+
+	::sim::SimTime total_waiting_time = 0;
+	::sim::SimTime total_time_on_trains = 0;
+
+	for (const auto& value_pair : sim_handle.getPassengerList()) {
+		const auto& passenger = value_pair.second;
+		const auto& hist_find_result = passenger_histories.find(passenger);
+		if (hist_find_result == end(passenger_histories)) {
+			continue;
+		}
+		const auto& psgr_history = hist_find_result->second;
+		if (psgr_history.getRoute().size() < 2) {
+			continue;
+		}
+
+		const ::sim::SimTime end_waiting_time = std::next(psgr_history.getRoute().begin())->getTime();
+		total_waiting_time += end_waiting_time - passenger.getStartTime();
+		total_time_on_trains += psgr_history.time_of_exit - end_waiting_time;
+		result.num_passengers_exited += 1;
+	}
+
+	if (result.num_passengers_exited != 0) {
+		result.mean_waiting_time = total_waiting_time / result.num_passengers_exited;
+		result.mean_time_on_trains = total_time_on_trains / result.num_passengers_exited;
+	}
+
+	return result;
+}
+
+RunSummary summarize_run(const ::sim::SimulatorHandle& sim_handle, const StreamingPassengerStats& streaming_stats) {
+	const auto& overall = streaming_stats.getOverall();
+
+	// passengers that exited can still be in the list, but streaming_stats already has them
+	const auto& simulator = *sim_handle.get();
+	const auto num_passengers_in_system = std::count_if(
+		sim_handle.getPassengerList().begin(), sim_handle.getPassengerList().end(),
+		[&](const auto& value_pair) { return simulator.hasExited(value_pair.first) == false; }
+	);
+
+	RunSummary result;
+	result.num_passengers_exited = overall.size();
+	result.num_passengers_entered = num_passengers_in_system + streaming_stats.getNumPassengersSeen();
+	result.mean_waiting_time = overall.waiting_times.mean();
+	result.mean_time_on_trains = overall.times_on_trains.mean();
+
+	return result;
+}
+
+double SampleStatistics::mean() const {
+	if (samples.empty()) {
+		return 0;
+	}
+	double sum = 0;
+	for (const auto& sample : samples) {
+		sum += sample;
+	}
+	return sum / samples.size();
+}
+
+double SampleStatistics::standardDeviation() const {
+	if (samples.size() < 2) {
+		return 0;
+	}
+	const auto sample_mean = mean();
+	double sum_of_squares = 0;
+	for (const auto& sample : samples) {
+		sum_of_squares += (sample - sample_mean) * (sample - sample_mean);
+	}
+	return std::sqrt(sum_of_squares / (samples.size() - 1));
+}
+
+std::pair<double, double> SampleStatistics::confidenceInterval95() const {
+	const auto sample_mean = mean();
+	if (samples.empty()) {
+		return { sample_mean, sample_mean };
+	}
+	const auto half_width = 1.96 * standardDeviation() / std::sqrt(samples.size());
+	return { sample_mean - half_width, sample_mean + half_width };
+}
+
+double SampleStatistics::quantile(double fraction) const {
+	if (samples.empty()) {
+		return 0;
+	}
+	if (!(0 <= fraction && fraction <= 1)) {
+		throw std::invalid_argument(std::string(__PRETTY_FUNCTION__) + ": fraction not in [0,1]");
+	}
+	auto sorted = samples;
+	const auto nth = sorted.begin() + static_cast<size_t>(std::lround(fraction * (sorted.size() - 1)));
+	std::nth_element(sorted.begin(), nth, sorted.end());
+	return *nth;
+}
+
+void report_replications(const std::vector<RunSummary>& runs, std::ostream& os) {
+	const auto report_one = [&](const std::string& name, const std::function<double(const RunSummary&)>& get_value) {
+		SampleStatistics stats;
+		for (const auto& run : runs) {
+			stats.add(get_value(run));
+		}
+		const auto ci = stats.confidenceInterval95();
+		os << name
+			<< ", " << stats.mean()
+			<< ", " << stats.standardDeviation()
+			<< ", [" << ci.first << ", " << ci.second << ']'
+			<< ", " << stats.quantile(0)
+			<< ", " << stats.quantile(0.05)
+			<< ", " << stats.quantile(0.5)
+			<< ", " << stats.quantile(0.95)
+			<< ", " << stats.quantile(1)
+			<< '\n';
+	};
+
+	os << "Replication Statistics Report\n";
+	os << "number of runs = " << runs.size() << '\n';
+	os << "quantity, mean, std. dev., 95% CI of mean, min, 5th pct., median, 95th pct., max\n";
+	os << "---------------------------------------------\n";
+	report_one("passengers entered",  [](const RunSummary& r) { return r.num_passengers_entered; });
+	report_one("passengers exited",   [](const RunSummary& r) { return r.num_passengers_exited; });
+	report_one("mean waiting time",   [](const RunSummary& r) { return r.mean_waiting_time; });
+	report_one("mean time on trains", [](const RunSummary& r) { return r.mean_time_on_trains; });
+	os << "---------------------------------------------\n";
+	os << "\n\n\n";
+}
+
+} // end namespace stats
@@ -0,0 +1,81 @@
+#ifndef STATS__REPLICATION_STATS_HPP
+#define STATS__REPLICATION_STATS_HPP
+
+#include <sim/simulator.h++>
+#include <stats/streaming_stats.h++>
+
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stats {
+
+/**
+ * The numbers from one simulation run that get compared across many runs
+ * (replications) with different passenger generator seeds.
+ */
+struct RunSummary {
+	size_t num_passengers_entered;
+	size_t num_passengers_exited;
+	double mean_waiting_time;
+	double mean_time_on_trains;
+
+	RunSummary()
+		: num_passengers_entered(0)
+		, num_passengers_exited(0)
+		, mean_waiting_time(0)
+		, mean_time_on_trains(0)
+	{ }
+};
+
+/**
+ * Boil a finished simulation down to a RunSummary. Waiting and on train times
+ * are averaged over the passengers that exited, the same way the
+ * simulation passenger report does.
+ */
+RunSummary summarize_run(const ::sim::SimulatorHandle& sim_handle);
+
+/**
+ * Same, but using the passengers that streaming_stats saw exit, for when the simulator
+ * wasn't keeping exited passengers. streaming_stats must have been observing from the
+ * start. Any exited passengers still in the passenger list are only counted once.
+ */
+RunSummary summarize_run(const ::sim::SimulatorHandle& sim_handle, const StreamingPassengerStats& streaming_stats);
+
+/**
+ * Collects samples of one quantity, and gives the usual statistics about them.
+ */
+class SampleStatistics {
+public:
+	SampleStatistics() : samples() { }
+
+	void add(double sample) { samples.push_back(sample); }
+
+	size_t size() const { return samples.size(); }
+	double mean() const;
+	double standardDeviation() const;
+
+	/**
+	 * The 95% confidence interval of the mean, using the normal approximation.
+	 * Wants a decent number of samples to mean much.
+	 */
+	std::pair<double, double> confidenceInterval95() const;
+
+	/**
+	 * The sample at fraction (in [0,1]) of the way through the sorted samples
+	 */
+	double quantile(double fraction) const;
+
+private:
+	std::vector<double> samples;
+};
+
+/**
+ * Print the distribution across runs of each thing in RunSummary
+ */
+void report_replications(const std::vector<RunSummary>& runs, std::ostream& os);
+
+} // end namespace stats
+
+#endif /* STATS__REPLICATION_STATS_HPP */
@@ -10,6 +10,7 @@ public:
 		PASSENGER_ROUTE_STATS,
 		SIMULATION_PASSENGER_STATS,
 		TRAIN_ROUTES,
+		PASSENGER_AGGREGATE_STATS, // needs a StreamingPassengerStats
 	};
 
 	ReportConfig(ReportType report_type)
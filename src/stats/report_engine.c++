@@ -2,6 +2,8 @@
 #include "report_engine_internal.h++"
 
 #include <sim/simulator_internal.h++>
+#include <util/logging.h++>
+#include <util/metrics.h++>
 #include <util/routing_utils.h++>
 
 #include <ostream>
@@ -24,12 +26,14 @@ const ReportEngine& ReportEngineHandle::operator*() const { return *ptr; }
 ReportEngineHandle make_report_engine(
 	const ::TrackNetwork& track_network,
 	const ::algo::Schedule&	schedule,
-	const ::sim::SimulatorHandle& sim_handle
+	const ::sim::SimulatorHandle& sim_handle,
+	const StreamingPassengerStats* streaming_stats
 ) {
 	return ReportEngineHandle(std::make_unique<ReportEngine>(
 		track_network,
 		schedule,
-		sim_handle
+		sim_handle,
+		streaming_stats
 	));
 }
 
@@ -38,6 +42,7 @@ void report_into(
 	const ReportConfig& config,
 	std::ostream& os
 ) {
+	metrics::ScopedTimer timer(metrics::Phase::REPORT);
 	switch (config.getReportType()) {
 		case ReportConfig::ReportType::PASSENGER_ROUTE_STATS:
 			rengine.reportPassengerRouteStats(config,os);
@@ -48,6 +53,9 @@ void report_into(
 		case ReportConfig::ReportType::TRAIN_ROUTES:
 			rengine.reportTrains(config,os);
 			return;
+		case ReportConfig::ReportType::PASSENGER_AGGREGATE_STATS:
+			rengine.reportPassengerAggregateStats(config,os);
+			return;
 	}
 }
 
@@ -60,19 +68,16 @@ void ReportEngine::reportPassengerRouteStats(const ReportConfig& config, std::os
 	os << "passenger, start time, departure time, arrival time, path...\n";
 	os << "---------------------------------------------\n";
 
+	// the simulator routed every passenger when it made them, so no need to do it again
+	const auto& routes = sim_handle.get()->getPassengerRoutes();
+
 	for (const auto& value_pair : getPassengers()) {
 		const auto& passenger = value_pair.second;
-		const auto& [route, ch] = algo::route_through_schedule(
-			track_network,
-			schedule,
-			passenger.getStartTime(),
-			passenger.getEntryID(),
-			passenger.getExitID()
-		);
-		(void)ch;
+		const auto& route = routes.getRoute(passenger);
 
 		TrackNetwork::Time start_time = passenger.getStartTime();
-		TrackNetwork::Time end_waiting_time = std::next(route.begin())->getTime();
+		// passengers already at their exit never board anything
+		TrackNetwork::Time end_waiting_time = route.size() > 1 ? std::next(route.begin())->getTime() : start_time;
 		TrackNetwork::Time end_travel_time = route.back().getTime();
 		totalWaitingTime += end_waiting_time - start_time;
 		totalTimeInSystem += end_travel_time - end_waiting_time;
@@ -143,4 +148,57 @@ void ReportEngine::reportTrains(const ReportConfig& config, std::ostream& os) {
 	os << "\n\n\n";
 }
 
+void ReportEngine::reportPassengerAggregateStats(const ReportConfig& config, std::ostream& os) {
+	(void)config;
+	if (streaming_stats == nullptr) {
+		::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
+			str << "can't make a passenger aggregate report without a StreamingPassengerStats\n";
+		});
+	}
+
+	const auto print_trip_stats = [&](const TripStatistics& trip_stats) {
+		for (const auto* histogram : { &trip_stats.waiting_times, &trip_stats.times_on_trains }) {
+			os << ", " << histogram->mean()
+				<< ", " << histogram->quantile(0.5)
+				<< ", " << histogram->quantile(0.9)
+				<< ", " << histogram->max();
+		}
+		os << '\n';
+	};
+
+	os << "Passenger Aggregate Statistics Report\n";
+	os << "passengers, waiting time mean, median, 90th percentile, max, time on trains mean, median, 90th percentile, max\n";
+	os << "---------------------------------------------\n";
+
+	const auto& overall = streaming_stats->getOverall();
+	os << "all: " << overall.size();
+	print_trip_stats(overall);
+
+	os << "---------------------------------------------\n";
+	os << "by entry station\n";
+	const auto& by_entry = streaming_stats->getByEntry();
+	for (const auto& station_id : track_network.getStaitonRange()) {
+		const auto& trip_stats = by_entry[station_id.getValue()];
+		if (trip_stats.size() == 0) {
+			continue;
+		}
+		os << track_network.getVertexName(station_id.getValue()) << ": " << trip_stats.size();
+		print_trip_stats(trip_stats);
+	}
+
+	os << "---------------------------------------------\n";
+	os << "by entry & exit station\n";
+	for (const auto& entry_exit_and_stats : streaming_stats->getByEntryAndExit()) {
+		const auto& entry_and_exit = entry_exit_and_stats.first;
+		os << track_network.getVertexName(entry_and_exit.first) << " -> " << track_network.getVertexName(entry_and_exit.second)
+			<< ": " << entry_exit_and_stats.second.size();
+		print_trip_stats(entry_exit_and_stats.second);
+	}
+
+	os << "---------------------------------------------\n";
+	os << "total waiting time   = " << overall.waiting_times.total() << '\n';
+	os << "total time on trains = " << overall.times_on_trains.total() << '\n';
+	os << "\n\n\n";
+}
+
 } // end namespace stats
@@ -15,6 +15,7 @@
 namespace stats {
 
 class ReportEngine;
+class StreamingPassengerStats;
 
 class ReportEngineHandle {
 	std::unique_ptr<ReportEngine> ptr;
@@ -27,10 +28,15 @@ public:
 	const ReportEngine& operator*() const;
 };
 
+/**
+ * streaming_stats is only needed for PASSENGER_AGGREGATE_STATS reports, and should have
+ * been observing sim_handle's simulator. Everything passed in must outlive the engine.
+ */
 ReportEngineHandle make_report_engine(
 	const ::TrackNetwork& track_network,
 	const ::algo::Schedule&	schedule,
-	const ::sim::SimulatorHandle& sim_handle
+	const ::sim::SimulatorHandle& sim_handle,
+	const StreamingPassengerStats* streaming_stats = nullptr
 );
 
 void report_into(
@@ -2,6 +2,7 @@
 #include "report_engine.h++"
 
 #include <stats/report_config.h++>
+#include <stats/streaming_stats.h++>
 
 namespace stats {
 
@@ -10,21 +11,25 @@ public:
 	ReportEngine(
 		const ::TrackNetwork& track_network,
 		const ::algo::Schedule&	schedule,
-		const ::sim::SimulatorHandle& sim_handle
+		const ::sim::SimulatorHandle& sim_handle,
+		const StreamingPassengerStats* streaming_stats
 	)
 		: track_network(track_network)
 		, schedule(schedule)
 		, sim_handle(sim_handle)
+		, streaming_stats(streaming_stats)
 	{ }
 
 private:
 	void reportPassengerRouteStats(const ReportConfig& config, std::ostream& os);
 	void reportSimulationPassengerStats(const ReportConfig& config, std::ostream& os);
 	void reportTrains(const ReportConfig& config, std::ostream& os);
+	void reportPassengerAggregateStats(const ReportConfig& config, std::ostream& os);
 
 	const ::TrackNetwork& track_network;
 	const ::algo::Schedule&	schedule;
 	const ::sim::SimulatorHandle& sim_handle;
+	const StreamingPassengerStats* streaming_stats;
 
 	const auto& getPassengers() { return sim_handle.getPassengerList(); }
 
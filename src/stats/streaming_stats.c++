@@ -0,0 +1,126 @@
+#include "streaming_stats.h++"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace stats {
+
+namespace {
+	/**
+	 * Writes str as a quoted CSV field, doubling any quotes in it, so that
+	 * commas, quotes and newlines (all allowed in graphviz ids) stay in one field.
+	 */
+	struct CsvQuoted {
+		const std::string& str;
+	};
+
+	std::ostream& operator<<(std::ostream& os, const CsvQuoted& quoted) {
+		os << '"';
+		for (const auto& c : quoted.str) {
+			if (c == '"') {
+				os << '"';
+			}
+			os << c;
+		}
+		return os << '"';
+	}
+}
+
+void Histogram::add(double value) {
+	value = std::max(value, 0.0);
+	const auto bin = static_cast<size_t>(value / bin_width);
+	if (bin >= bin_counts.size()) {
+		bin_counts.resize(bin + 1, 0);
+	}
+	bin_counts[bin] += 1;
+	num_values += 1;
+	sum += value;
+	max_value = std::max(max_value, value);
+}
+
+double Histogram::mean() const {
+	if (num_values == 0) {
+		return 0;
+	}
+	return sum / num_values;
+}
+
+double Histogram::quantile(double fraction) const {
+	if (num_values == 0) {
+		return 0;
+	}
+	if (!(0 <= fraction && fraction <= 1)) {
+		throw std::invalid_argument(std::string(__PRETTY_FUNCTION__) + ": fraction not in [0,1]");
+	}
+	// same rank as SampleStatistics::quantile
+	const auto rank = static_cast<size_t>(std::lround(fraction * (num_values - 1)));
+	size_t num_seen = 0;
+	for (size_t bin = 0; bin != bin_counts.size(); ++bin) {
+		num_seen += bin_counts[bin];
+		if (num_seen > rank) {
+			return bin * bin_width;
+		}
+	}
+	return max_value;
+}
+
+StreamingPassengerStats::StreamingPassengerStats(const TrackNetwork& tn, std::unique_ptr<std::ostream>&& records_os)
+	: track_network(tn)
+	, records_os(std::move(records_os))
+	, num_passengers_seen(0)
+	, overall()
+	, by_entry(tn.makeStationMap<TripStatistics>())
+	, by_entry_and_exit()
+{
+	if (this->records_os) {
+		(*this->records_os) << "passenger,entry,exit,start_time,boarding_time,exit_time,waiting_time,time_on_trains,num_trains\n";
+	}
+}
+
+void StreamingPassengerStats::observe(::sim::SimulatorHandle& sim_handle) {
+	sim_handle.registerPassengerExitObserver([this](const auto& passenger, const auto& time_of_exit, const auto& path) {
+		this->addPassenger(passenger, time_of_exit, path);
+	});
+}
+
+void StreamingPassengerStats::addPassenger(
+	const Passenger& passenger,
+	const ::sim::SimTime& time_of_exit,
+	const ::algo::PassengerRoutes::RouteType& path
+) {
+	num_passengers_seen += 1;
+
+	const bool boarded_something = path.size() >= 2;
+	const ::sim::SimTime start_time = passenger.getStartTime();
+	const ::sim::SimTime end_waiting_time = boarded_something ? std::next(path.begin())->getTime() : time_of_exit;
+	const auto waiting_time = end_waiting_time - start_time;
+	const auto time_on_trains = time_of_exit - end_waiting_time;
+
+	if (boarded_something) {
+		overall.add(waiting_time, time_on_trains);
+		by_entry[passenger.getEntryID()].add(waiting_time, time_on_trains);
+		by_entry_and_exit[{passenger.getEntryID(), passenger.getExitID()}].add(waiting_time, time_on_trains);
+	}
+
+	if (records_os) {
+		const auto num_trains = std::count_if(path.begin(), path.end(), [](const auto& route_element) {
+			return route_element.getLocation().isTrain();
+		});
+		(*records_os)
+			<< CsvQuoted{passenger.getName()} << ','
+			<< CsvQuoted{track_network.getVertexName(passenger.getEntryID())} << ','
+			<< CsvQuoted{track_network.getVertexName(passenger.getExitID())} << ','
+			<< start_time << ','
+			<< end_waiting_time << ','
+			<< time_of_exit << ','
+			<< waiting_time << ','
+			<< time_on_trains << ','
+			<< num_trains << '\n'
+		;
+	}
+}
+
+} // end namespace stats
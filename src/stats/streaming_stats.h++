@@ -0,0 +1,131 @@
+
+#ifndef STATS__STREAMING_STATS_HPP
+#define STATS__STREAMING_STATS_HPP
+
+#include <sim/simulator.h++>
+
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace stats {
+
+/**
+ * Counts of values in bins of a fixed width, starting at 0, so that the
+ * memory used doesn't depend on how many values are added. Quantiles are
+ * exact for whole numbers if the bin width is 1, which is the case for
+ * passenger times, as the schedule is in whole time units.
+ */
+class Histogram {
+public:
+	Histogram(double bin_width = 1)
+		: bin_width(bin_width)
+		, bin_counts()
+		, num_values(0)
+		, sum(0)
+		, max_value(0)
+	{ }
+
+	/**
+	 * Negative values are counted as 0
+	 */
+	void add(double value);
+
+	size_t size() const { return num_values; }
+	double total() const { return sum; }
+	double mean() const;
+	double max() const { return max_value; }
+
+	/**
+	 * The bottom of the bin that the value fraction (in [0,1]) of the way
+	 * through the sorted values is in
+	 */
+	double quantile(double fraction) const;
+
+private:
+	double bin_width;
+	std::vector<size_t> bin_counts;
+	size_t num_values;
+	double sum;
+	double max_value;
+};
+
+/**
+ * The distributions of the waiting and on train times of some passengers
+ */
+struct TripStatistics {
+	Histogram waiting_times;
+	Histogram times_on_trains;
+
+	TripStatistics() : waiting_times(), times_on_trains() { }
+
+	void add(double waiting_time, double time_on_trains) {
+		waiting_times.add(waiting_time);
+		times_on_trains.add(time_on_trains);
+	}
+
+	size_t size() const { return waiting_times.size(); }
+};
+
+/**
+ * Folds each passenger into running statistics as it exits a simulation, instead of
+ * going over every passenger's history after the simulation is over, so the simulator
+ * doesn't need to keep them (see SimulatorHandle::setKeepExitedPassengers). Has statistics
+ * for all passengers, for each entry station, and for each (entry, exit) pair. Can also
+ * write a CSV line for each passenger as it exits.
+ * Not thread safe, so use one per simulation.
+ */
+class StreamingPassengerStats {
+public:
+	using EntryExitPair = std::pair<TrackNetwork::NodeID, TrackNetwork::NodeID>;
+
+	/**
+	 * If records_os is not null, it gets a CSV header, then a record for each passenger
+	 */
+	StreamingPassengerStats(const TrackNetwork& tn, std::unique_ptr<std::ostream>&& records_os = nullptr);
+
+	StreamingPassengerStats(const StreamingPassengerStats&) = delete;
+	StreamingPassengerStats& operator=(const StreamingPassengerStats&) = delete;
+
+	/**
+	 * Have sim_handle call addPassenger as each passenger exits.
+	 * This object must outlive the simulator.
+	 */
+	void observe(::sim::SimulatorHandle& sim_handle);
+
+	/**
+	 * Passengers with a path of less than two elements never boarded anything. They only
+	 * get a record, and are left out of the statistics, same as in the simulation passenger report.
+	 */
+	void addPassenger(
+		const Passenger& passenger,
+		const ::sim::SimTime& time_of_exit,
+		const ::algo::PassengerRoutes::RouteType& path
+	);
+
+	const TrackNetwork& getTrackNetwork() const { return track_network; }
+
+	/**
+	 * Every passenger given to addPassenger, including the ones that never boarded anything
+	 */
+	size_t getNumPassengersSeen() const { return num_passengers_seen; }
+
+	const TripStatistics& getOverall() const { return overall; }
+	const StationMap<TripStatistics>& getByEntry() const { return by_entry; }
+	const std::map<EntryExitPair, TripStatistics>& getByEntryAndExit() const { return by_entry_and_exit; }
+
+private:
+	const TrackNetwork& track_network;
+	std::unique_ptr<std::ostream> records_os;
+
+	size_t num_passengers_seen;
+	TripStatistics overall;
+	StationMap<TripStatistics> by_entry;
+	std::map<EntryExitPair, TripStatistics> by_entry_and_exit; // ordered, for the reports
+};
+
+} // end namespace stats
+
+#endif /* STATS__STREAMING_STATS_HPP */
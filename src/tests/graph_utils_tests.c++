@@ -0,0 +1,197 @@
+#include <tests/test_utils.h++>
+
+#include <util/graph_utils.h++>
+#include <util/network_generators.h++>
+#include <util/routing_utils.h++>
+
+#include <boost/property_map/function_property_map.hpp>
+
+#include <cmath>
+#include <random>
+#include <utility>
+
+namespace {
+
+using Oracle = ::util::TrackNetworkShortestPathOracle;
+
+template<typename WEIGHT_MAP>
+double route_length(const std::vector<TrackNetwork::NodeID>& route, const TrackNetwork& tn, const WEIGHT_MAP& weight_map) {
+	double length = 0;
+	for (size_t i = 1; i < route.size(); ++i) {
+		const auto edge_and_found = boost::edge(route[i - 1], route[i], tn.g());
+		if (!edge_and_found.second) {
+			return -1;
+		}
+		length += get(weight_map, edge_and_found.first);
+	}
+	return length;
+}
+
+/**
+ * Checks that the route the tree picked to end is the one ShortestPathTree promises:
+ * each vertex is reached from the lowest indexed strictly closer vertex that it can be.
+ */
+template<typename TREE, typename WEIGHT_MAP>
+void check_picks_lowest_index_predecessors(const TREE& tree, TrackNetwork::NodeID end, const TrackNetwork& tn, const WEIGHT_MAP& weight_map) {
+	const auto route = tree.getRouteTo(end);
+	for (size_t i = 1; i < route.size(); ++i) {
+		auto lowest = route[i - 1];
+		for (const auto& e : make_iterable(edges(tn.g()))) {
+			const auto from = source(e, tn.g());
+			if (target(e, tn.g()) == route[i] && from < lowest && tree.reaches(from)
+				&& tree.getDistanceTo(from) < tree.getDistanceTo(route[i])
+				&& tree.getDistanceTo(from) + get(weight_map, e) == tree.getDistanceTo(route[i])
+			) {
+				lowest = from;
+			}
+		}
+		CHECK_EQUAL(route[i - 1], lowest);
+	}
+}
+
+/**
+ * Checks that one ShortestPathTree, reused for every start, gives routes as long as its
+ * distances, and that get_shortest_routes, given the pairs in a shuffled order with
+ * repeated starts, gives the same routes as get_shortest_route does for each pair.
+ */
+template<typename WEIGHT_MAP>
+void check_trees_against_single_searches(const TrackNetwork& tn, const WEIGHT_MAP& weight_map) {
+	const auto num_vertices = boost::num_vertices(tn.g());
+	::util::ShortestPathTree<TrackNetwork::BackingGraphType, double> tree(tn.g());
+
+	std::vector<std::pair<TrackNetwork::NodeID, TrackNetwork::NodeID>> start_end_pairs;
+	size_t num_unreachable = 0;
+	for (TrackNetwork::NodeID start = 0; start != num_vertices; ++start) {
+		tree.computeTreeFrom(start, weight_map);
+		CHECK_EQUAL(tree.getStart(), start);
+		for (TrackNetwork::NodeID end = 0; end != num_vertices; ++end) {
+			start_end_pairs.emplace_back(start, end);
+			const auto route = tree.getRouteTo(end);
+			CHECK_EQUAL(route.front(), start);
+
+			if (!tree.reaches(end)) {
+				num_unreachable += 1;
+				CHECK_EQUAL(route.size(), 1u);
+				continue;
+			}
+
+			CHECK_EQUAL(route.back(), end);
+			CHECK(std::abs(route_length(route, tn, weight_map) - tree.getDistanceTo(end)) < 1e-9);
+			check_picks_lowest_index_predecessors(tree, end, tn, weight_map);
+		}
+	}
+
+	std::shuffle(start_end_pairs.begin(), start_end_pairs.end(), std::mt19937(3));
+	const auto routes = ::util::get_shortest_routes(start_end_pairs, tn.g(), weight_map);
+	CHECK_EQUAL(routes.size(), start_end_pairs.size());
+	for (size_t ipair = 0; ipair != start_end_pairs.size(); ++ipair) {
+		const auto& start_end_pair = start_end_pairs[ipair];
+		CHECK(routes[ipair] == ::util::get_shortest_route(start_end_pair.first, start_end_pair.second, tn.g(), weight_map));
+	}
+
+	// the generated networks are directed, so some pairs should have no route
+	CHECK(num_unreachable > 0);
+}
+
+/**
+ * Checks every (start, end) pair of tn's oracle, with few and with many landmarks,
+ * against a ShortestPathTree, using weight_map for the queries. The routes have to be
+ * exactly the same, not just as short, as the schedulers depend on which is picked.
+ */
+template<typename WEIGHT_MAP>
+void check_oracle_against_trees(const TrackNetwork& tn, const WEIGHT_MAP& weight_map, bool use_default_weights) {
+	const auto num_vertices = boost::num_vertices(tn.g());
+	::util::ShortestPathTree<TrackNetwork::BackingGraphType, double> tree(tn.g());
+
+	for (const size_t num_landmarks : {size_t(1), size_t(3), Oracle::DEFAULT_NUM_LANDMARKS}) {
+		auto oracle = ::util::make_shortest_path_oracle(tn, num_landmarks);
+		CHECK_EQUAL(oracle.getNumPreprocessingSearches(), 2*oracle.getLandmarks().size() + 1);
+		for (TrackNetwork::NodeID start = 0; start != num_vertices; ++start) {
+			tree.computeTreeFrom(start, weight_map);
+			for (TrackNetwork::NodeID end = 0; end != num_vertices; ++end) {
+				const auto route = use_default_weights ? oracle.getRoute(start, end) : oracle.getRoute(start, end, weight_map);
+				CHECK(route == tree.getRouteTo(end));
+
+				if (!tree.reaches(end)) {
+					if (use_default_weights) {
+						CHECK_EQUAL(oracle.getDistance(start, end), Oracle::UNREACHABLE);
+					}
+					continue;
+				}
+
+				if (use_default_weights) {
+					CHECK_EQUAL(oracle.getDistance(start, end), tree.getDistanceTo(end));
+					CHECK(oracle.getLowerBound(start, end) <= tree.getDistanceTo(end) + 1e-9);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Calls func(weight_map, is_default) with tn's own weights, then with inflated ones like
+ * Scheduler2's: by random amounts, and by random powers of 1.2, which leaves lots of ties.
+ */
+template<typename FUNC>
+void for_each_test_weight_map(const TrackNetwork& tn, FUNC&& func) {
+	func(boost::get(&TrackNetwork::EdgeProperties::weight, tn.g()), true);
+
+	std::mt19937 rand_gen(5);
+	auto randomly_inflated_weights = tn.makeEdgeWeightMapCopy();
+	for (auto& weight : randomly_inflated_weights) {
+		weight *= std::uniform_real_distribution<double>(1, 4)(rand_gen);
+	}
+	auto powers_inflated_weights = tn.makeEdgeWeightMapCopy();
+	for (auto& weight : powers_inflated_weights) {
+		for (auto num_times = std::uniform_int_distribution<int>(0, 3)(rand_gen); num_times != 0; --num_times) {
+			weight *= 1.2;
+		}
+	}
+
+	for (const auto* inflated_weights : {&randomly_inflated_weights, &powers_inflated_weights}) {
+		auto inflated_weights_f = [&](TrackNetwork::EdgeID edge_desc) {
+			return (*inflated_weights)[tn.getEdgeIndex(edge_desc)];
+		};
+		func(boost::make_function_property_map<TrackNetwork::EdgeID, double>(inflated_weights_f), false);
+	}
+}
+
+void check_trees_on(::util::NetworkTopology topology, size_t size) {
+	const auto tn = ::util::make_network(topology, size);
+	for_each_test_weight_map(tn, [&](const auto& weight_map, bool) {
+		check_trees_against_single_searches(tn, weight_map);
+	});
+}
+
+void check_oracle_on(::util::NetworkTopology topology, size_t size) {
+	const auto tn = ::util::make_network(topology, size);
+	for_each_test_weight_map(tn, [&](const auto& weight_map, bool is_default) {
+		check_oracle_against_trees(tn, weight_map, is_default);
+	});
+}
+
+} // end anonymous namespace
+
+TEST_CASE(shortest_path_trees_match_single_searches_on_grid) {
+	check_trees_on(::util::NetworkTopology::GRID, 36);
+}
+
+TEST_CASE(shortest_path_trees_match_single_searches_on_branching) {
+	check_trees_on(::util::NetworkTopology::BRANCHING, 30);
+}
+
+TEST_CASE(shortest_path_trees_match_single_searches_on_cross) {
+	check_trees_on(::util::NetworkTopology::CROSS, 30);
+}
+
+TEST_CASE(shortest_path_oracle_matches_trees_on_grid) {
+	check_oracle_on(::util::NetworkTopology::GRID, 36);
+}
+
+TEST_CASE(shortest_path_oracle_matches_trees_on_branching) {
+	check_oracle_on(::util::NetworkTopology::BRANCHING, 30);
+}
+
+TEST_CASE(shortest_path_oracle_matches_trees_on_cross) {
+	check_oracle_on(::util::NetworkTopology::CROSS, 30);
+}
@@ -0,0 +1,141 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <sim/simulator.h++>
+#include <util/network_generators.h++>
+#include <util/passenger_generator.h++>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Time = PassengerGenerator::Time;
+const Time NEVER = std::numeric_limits<Time>::max();
+
+/**
+ * The departure times before end_time, found the way nextPassengerAfter used to,
+ * by replaying the random draws from time 0 for each one
+ */
+std::vector<Time> replayed_departures(StatisticalPassenger::AverageRate rate, PassengerGenerator::Seed seed, Time end_time) {
+	const auto replayed_next_after = [&](Time t) -> Time {
+		if (rate == 0) {
+			return NEVER;
+		} else if (rate == 1) {
+			return t + 1;
+		}
+		PassengerGenerator::RandGen rand_gen(seed);
+		std::geometric_distribution<Time> geom_dist(rate);
+		Time prev = 0;
+		while (true) {
+			if (prev > t) {
+				return prev;
+			}
+			prev += geom_dist(rand_gen);
+		}
+	};
+
+	std::vector<Time> result;
+	for (auto t = replayed_next_after(0); t < end_time; t = replayed_next_after(t)) {
+		result.push_back(t);
+	}
+	return result;
+}
+
+std::vector<Time> cursor_departures(const PassengerGenerator& p_gen, Time end_time) {
+	auto departures = p_gen.makeDepartureCursor();
+	std::vector<Time> result;
+	for (auto t = departures.firstPassengerAtOrAfter(0); t < end_time; t = departures.nextPassengerAfter(t)) {
+		result.push_back(t);
+	}
+	return result;
+}
+
+} // end anonymous namespace
+
+TEST_CASE(departure_times_are_unchanged) {
+	// each generator gets the factory's seed plus its index plus one
+	const std::vector<StatisticalPassenger> demand{
+		StatisticalPassenger("often", 0, 1, 0.3),
+		StatisticalPassenger("rarely", 0, 1, 0.05),
+	};
+	const auto p_gens = PassengerGeneratorFactory(1, demand).sample();
+
+	const std::vector<Time> expected_often{6, 11, 15, 22, 25, 27, 36, 40, 57, 59, 60, 61};
+	auto often = cursor_departures(p_gens[0], 62);
+	CHECK(often == expected_often);
+
+	for (const auto& rate : {0.5, 0.3, 0.05, 0.01, 0.97}) {
+		const std::vector<StatisticalPassenger> one_passenger{StatisticalPassenger("p", 0, 1, rate)};
+		const auto seed = 7;
+		const auto p_gen = PassengerGeneratorFactory(seed - 1, one_passenger).sample().at(0);
+		const auto expected = replayed_departures(rate, seed, 5000);
+		CHECK(expected.empty() == false);
+		CHECK(cursor_departures(p_gen, 5000) == expected);
+
+		// and asking about times that aren't departures, fractional ones, and the same one twice
+		auto departures = p_gen.makeDepartureCursor();
+		for (Time t = 0; t < expected.back(); t += 37) {
+			const auto next = *std::upper_bound(expected.begin(), expected.end(), t);
+			CHECK_EQUAL(departures.nextPassengerAfter(t), next);
+			CHECK_EQUAL(departures.nextPassengerAfter(t), next);
+			CHECK_EQUAL(departures.firstPassengerAtOrAfter(t + 0.5), next);
+			CHECK_EQUAL(p_gen.nextPassengerAfter(t), next);
+		}
+	}
+}
+
+TEST_CASE(departure_times_for_rates_zero_and_one) {
+	const std::vector<StatisticalPassenger> demand{
+		StatisticalPassenger("never", 0, 1, 0),
+		StatisticalPassenger("always", 0, 1, 1),
+	};
+	const auto p_gens = PassengerGeneratorFactory(1, demand).sample();
+
+	auto never = p_gens[0].makeDepartureCursor();
+	CHECK_EQUAL(never.firstPassengerAtOrAfter(0), NEVER);
+	CHECK_EQUAL(never.nextPassengerAfter(10), NEVER);
+
+	const std::vector<Time> one_to_nine{1, 2, 3, 4, 5, 6, 7, 8, 9};
+	CHECK(cursor_departures(p_gens[1], 10) == one_to_nine);
+	auto always = p_gens[1].makeDepartureCursor();
+	CHECK_EQUAL(always.firstPassengerAtOrAfter(3.5), 4);
+	CHECK_EQUAL(always.firstPassengerAtOrAfter(4), 4);
+}
+
+TEST_CASE(simulator_spawns_the_replayed_departures) {
+	const ::tests::NetworkScenario scenario(::util::NetworkTopology::GRID, 25);
+	const auto& demand = scenario.demand;
+	const ::sim::SimTime end_time = 200;
+
+	std::vector<std::pair<std::string, Time>> expected;
+	for (size_t i = 0; i != demand.size(); ++i) {
+		for (const auto& t : replayed_departures(demand[i].getAverageRate(), 1 + i + 1, end_time)) {
+			expected.emplace_back(demand[i].getBaseName(), t);
+		}
+	}
+	std::sort(expected.begin(), expected.end());
+
+	for (const auto& mode : {::sim::SimulationMode::FIXED_STEP, ::sim::SimulationMode::EVENT_DRIVEN}) {
+		const auto passenger_generators = PassengerGeneratorFactory(1, demand).sample();
+		auto sim_handle = ::sim::instantiate_simulator(&passenger_generators, scenario.schedule, scenario.tn, mode);
+		for (const auto& time_to_run : {50.5, 0.25, 99.25, 50.0}) {
+			sim_handle.runForTime(time_to_run, 0.7);
+		}
+
+		std::vector<std::pair<std::string, Time>> spawned;
+		for (const auto& id_and_passenger : sim_handle.getPassengerList()) {
+			spawned.emplace_back(id_and_passenger.second.getName(), id_and_passenger.second.getStartTime());
+		}
+		std::sort(spawned.begin(), spawned.end());
+
+		CHECK_EQUAL(spawned.size(), expected.size());
+		CHECK(spawned == expected);
+	}
+}
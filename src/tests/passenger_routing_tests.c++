@@ -0,0 +1,297 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/passenger_routing.h++>
+#include <algo/scheduler.h++>
+#include <algo/timetable.h++>
+#include <util/location_id.h++>
+#include <util/metrics.h++>
+#include <util/network_generators.h++>
+#include <util/routing_utils.h++>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+std::string describe_route(const ::algo::PassengerRoutes::RouteType& route, const TrackNetwork& tn) {
+	std::ostringstream os;
+	::util::print_route_of_route_elements(route, tn, os);
+	return os.str();
+}
+
+using Query = std::tuple<TrackNetwork::Time, TrackNetwork::NodeID, TrackNetwork::NodeID>; // start time, entry, exit
+
+/**
+ * Every (entry, exit) pair, leaving at every time in [0,max_start_time), shuffled
+ */
+std::vector<Query> make_queries(const TrackNetwork& tn, TrackNetwork::Time max_start_time, uint64_t seed) {
+	std::vector<Query> queries;
+	for (TrackNetwork::NodeID entry = 0; entry != num_vertices(tn.g()); ++entry) {
+		for (TrackNetwork::NodeID exit = 0; exit != num_vertices(tn.g()); ++exit) {
+			for (TrackNetwork::Time t = 0; t != max_start_time; ++t) {
+				queries.emplace_back(t, entry, exit);
+			}
+		}
+	}
+	std::shuffle(queries.begin(), queries.end(), std::mt19937_64(seed));
+	return queries;
+}
+
+/**
+ * Asks a cache everything in make_queries, and checks each answer against a search
+ * without one. Asking in a random order means that the cache has answers from both
+ * earlier and later start times when it is asked.
+ */
+void check_cache_against_searching(const TrackNetwork& tn, const ::algo::Schedule& sch, uint64_t seed) {
+	const ::algo::Timetable timetable(sch, tn);
+	::algo::RouteTroughScheduleCacheHandle cache_handle;
+
+	metrics::reset();
+	metrics::enable();
+	for (const auto& query : make_queries(tn, 40, seed)) {
+		::algo::PassengerRoutes::RouteType cached;
+		std::tie(cached, cache_handle) = ::algo::route_through_schedule(
+			tn, sch, std::get<0>(query), std::get<1>(query), std::get<2>(query), std::move(cache_handle)
+		);
+		const auto searched = ::algo::route_through_schedule(tn, timetable, std::get<0>(query), std::get<1>(query), std::get<2>(query));
+		CHECK_EQUAL(describe_route(cached, tn), describe_route(searched, tn));
+	}
+	metrics::enable(false);
+
+	CHECK(metrics::get(metrics::Counter::ROUTES_FROM_CACHE) > 0);
+}
+
+/**
+ * Routes a lot of passengers with several threads sharing a cache, and checks
+ * that they get the same routes as with one thread.
+ */
+void check_threads_get_same_routes(const TrackNetwork& tn, const ::algo::Schedule& sch, uint64_t seed) {
+	const ::algo::Timetable timetable(sch, tn);
+	auto demand = ::util::make_demand(tn, 30, 0.5, seed);
+	// route_passengers expects everyone to have a route, and a scrambled schedule may not give them one
+	demand.erase(std::remove_if(demand.begin(), demand.end(), [&](const auto& statpsgr) {
+		return ::algo::route_through_schedule(tn, timetable, 0, statpsgr.getEntryID(), statpsgr.getExitID()).empty();
+	}), demand.end());
+	CHECK(!demand.empty());
+
+	PassengerList passengers;
+	std::mt19937_64 rand_gen(seed);
+	for (uint i = 0; i != 3000; ++i) {
+		const auto& statpsgr = demand.at(std::uniform_int_distribution<size_t>(0, demand.size() - 1)(rand_gen));
+		passengers.push_back(::instantiateAt(&statpsgr, ::util::make_id<PassengerID>(i), std::uniform_int_distribution<TrackNetwork::Time>(0, 100)(rand_gen)));
+	}
+
+	const auto one_thread = ::algo::route_passengers(tn, sch, passengers, ::algo::RouteTroughScheduleCacheHandle(), 1).first;
+	for (const auto& num_threads : {2, 8}) {
+		const auto many_threads = ::algo::route_passengers(tn, sch, passengers, ::algo::RouteTroughScheduleCacheHandle(), num_threads).first;
+		for (const auto& passenger : passengers) {
+			CHECK_EQUAL(describe_route(many_threads.getRoute(passenger), tn), describe_route(one_thread.getRoute(passenger), tn));
+		}
+	}
+}
+
+/**
+ * Where and when a train is, for each position of its route's path
+ */
+struct ScannedTrain {
+	const ::algo::TrainRoute* route;
+	std::vector<TrackNetwork::Time> times;
+};
+
+/**
+ * Every train of sch that leaves before horizon, made with makeTrainFromIndex
+ */
+std::vector<ScannedTrain> scan_trains(const TrackNetwork& tn, const ::algo::Schedule& sch, TrackNetwork::Time horizon) {
+	std::vector<ScannedTrain> trains;
+	for (const auto& route : sch.getTrainRoutes()) {
+		for (::algo::TrainIndex train_index = 0; ; ++train_index) {
+			const auto train = route.makeTrainFromIndex(train_index);
+			if (train.getDepartureTime() >= horizon) {
+				break;
+			}
+			trains.push_back({&route, {}});
+			for (auto it = route.getPath().begin(); it != route.getPath().end(); ++it) {
+				trains.back().times.push_back(train.getExpectedArrivalTime(it, tn));
+			}
+		}
+	}
+	return trains;
+}
+
+/**
+ * For each k, the earliest time each vertex can be reached at by taking exactly k
+ * trains, found by trying to board every train at every stop, k times over.
+ * Uses the same 1 time unit to get off a train as the router.
+ */
+std::vector<std::vector<TrackNetwork::Time>> earliest_arrivals_by_num_boardings(
+	const std::vector<ScannedTrain>& trains,
+	size_t num_vertices,
+	TrackNetwork::Time start_time,
+	TrackNetwork::NodeID start_vertex
+) {
+	const auto never = std::numeric_limits<TrackNetwork::Time>::max();
+	std::vector<std::vector<TrackNetwork::Time>> arrivals(1, std::vector<TrackNetwork::Time>(num_vertices, never));
+	arrivals[0][start_vertex] = start_time;
+
+	// nothing that isn't a loop takes more trains than there are vertices
+	for (size_t num_boardings = 1; num_boardings <= num_vertices; ++num_boardings) {
+		const auto& before = arrivals.back();
+		std::vector<TrackNetwork::Time> after(num_vertices, never);
+		for (const auto& train : trains) {
+			const auto& path = train.route->getPath();
+			bool on_board = false;
+			for (size_t position = 0; position != path.size(); ++position) {
+				if (on_board) {
+					after[path[position]] = std::min(after[path[position]], train.times[position] + 1);
+				}
+				if (before[path[position]] <= train.times[position]) {
+					on_board = true;
+				}
+			}
+		}
+		arrivals.push_back(std::move(after));
+	}
+	return arrivals;
+}
+
+/**
+ * Check that every train in route really goes from the station before it,
+ * when it says, to the station after it.
+ */
+void check_route_is_real(const ::algo::PassengerRoutes::RouteType& route, const ::algo::Schedule& sch, const TrackNetwork& tn) {
+	for (size_t i = 1; i + 1 < route.size(); i += 2) {
+		CHECK(route[i - 1].getLocation().isStation() && route[i].getLocation().isTrain() && route[i + 1].getLocation().isStation());
+		const auto train_id = route[i].getLocation().asTrainID();
+		const auto& train_route = sch.getTrainRoute(train_id.getRouteID());
+		const auto train = train_route.makeTrainFromIndex(train_id.getTrainIndex());
+		const auto& path = train_route.getPath();
+
+		bool boarded = false;
+		bool alighted = false;
+		for (auto it = path.begin(); it != path.end() && !alighted; ++it) {
+			const auto station = tn.getStationIDByVertexID(*it);
+			const auto time = train.getExpectedArrivalTime(it, tn);
+			if (boarded && station == route[i + 1].getLocation().asStationID() && time + 1 == route[i + 1].getTime()) {
+				alighted = true;
+			}
+			if (station == route[i - 1].getLocation().asStationID() && time == route[i].getTime() && route[i - 1].getTime() <= time) {
+				boarded = true;
+			}
+		}
+		CHECK(alighted);
+	}
+}
+
+/**
+ * Check the route from every vertex to every other, leaving at a few different times,
+ * against the earliest arrivals from earliest_arrivals_by_num_boardings. The router should
+ * find the earliest arrival, and no route with the same arrival should take fewer trains.
+ */
+void check_router_against_trying_every_train(const TrackNetwork& tn, const ::algo::Schedule& sch) {
+	const ::algo::Timetable timetable(sch, tn);
+	const auto never = std::numeric_limits<TrackNetwork::Time>::max();
+	const TrackNetwork::Time horizon = 400;
+	const auto trains = scan_trains(tn, sch, horizon);
+	const auto num_vertices = timetable.getNumVertices();
+
+	size_t num_without_route = 0;
+	size_t num_with_equally_early_routes = 0;
+	for (TrackNetwork::NodeID start_vertex = 0; start_vertex != num_vertices; ++start_vertex) {
+		for (TrackNetwork::Time start_time = 0; start_time < 40; start_time += 7) {
+			const auto arrivals = earliest_arrivals_by_num_boardings(trains, num_vertices, start_time, start_vertex);
+
+			for (TrackNetwork::NodeID goal_vertex = 0; goal_vertex != num_vertices; ++goal_vertex) {
+				auto earliest_arrival = never;
+				size_t fewest_boardings = 0;
+				for (size_t num_boardings = 0; num_boardings != arrivals.size(); ++num_boardings) {
+					if (arrivals[num_boardings][goal_vertex] < earliest_arrival) {
+						earliest_arrival = arrivals[num_boardings][goal_vertex];
+						fewest_boardings = num_boardings;
+					}
+				}
+				const auto route = ::algo::route_through_schedule(tn, timetable, start_time, start_vertex, goal_vertex);
+
+				if (earliest_arrival == never) {
+					num_without_route += 1;
+					CHECK(route.empty());
+					continue;
+				}
+				// or some trains that could be part of the best route weren't scanned
+				CHECK(earliest_arrival < horizon / 2);
+
+				CHECK(!route.empty());
+				if (start_vertex == goal_vertex) {
+					CHECK_EQUAL(route.size(), 1u);
+				}
+				CHECK_EQUAL(route.front().getTime(), start_time);
+				CHECK(route.front().getLocation() == LocationID(tn.getStationIDByVertexID(start_vertex)));
+				CHECK(route.back().getLocation() == LocationID(tn.getStationIDByVertexID(goal_vertex)));
+				CHECK_EQUAL(route.back().getTime(), earliest_arrival);
+				CHECK_EQUAL(route.size() / 2, fewest_boardings);
+				check_route_is_real(route, sch, tn);
+
+				for (size_t num_boardings = fewest_boardings + 1; num_boardings != arrivals.size(); ++num_boardings) {
+					if (arrivals[num_boardings][goal_vertex] == earliest_arrival) {
+						num_with_equally_early_routes += 1;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// make sure that these cases were actually looked at
+	CHECK(num_without_route > 0);
+	CHECK(num_with_equally_early_routes > 0);
+}
+
+} // end anonymous namespace
+
+TEST_CASE(router_matches_trying_every_train_on_grid) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::GRID, 16);
+	for (uint64_t seed = 1; seed <= 4; ++seed) {
+		check_router_against_trying_every_train(tn, ::tests::make_scrambled_schedule(tn, seed));
+	}
+}
+
+TEST_CASE(router_matches_trying_every_train_on_branching) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::BRANCHING, 20);
+	for (uint64_t seed = 1; seed <= 4; ++seed) {
+		check_router_against_trying_every_train(tn, ::tests::make_scrambled_schedule(tn, seed));
+	}
+}
+
+TEST_CASE(router_matches_trying_every_train_on_cross) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::CROSS, 16);
+	for (uint64_t seed = 1; seed <= 4; ++seed) {
+		check_router_against_trying_every_train(tn, ::tests::make_scrambled_schedule(tn, seed));
+	}
+}
+
+TEST_CASE(cached_routes_match_searching_on_grid) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::GRID, 25);
+	for (uint64_t seed = 1; seed <= 3; ++seed) {
+		check_cache_against_searching(tn, ::tests::make_scrambled_schedule(tn, seed), seed);
+	}
+	check_cache_against_searching(tn, ::algo::schedule(tn, ::util::make_demand(tn, 12, 0.1, 1)), 1);
+}
+
+TEST_CASE(cached_routes_match_searching_on_cross) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::CROSS, 20);
+	for (uint64_t seed = 1; seed <= 3; ++seed) {
+		check_cache_against_searching(tn, ::tests::make_scrambled_schedule(tn, seed), seed);
+	}
+}
+
+TEST_CASE(routing_with_threads_matches_one_thread) {
+	for (const auto& topology : {::util::NetworkTopology::GRID, ::util::NetworkTopology::BRANCHING}) {
+		const auto tn = ::util::make_network(topology, 36);
+		check_threads_get_same_routes(tn, ::tests::make_scrambled_schedule(tn, 4), 4);
+	}
+}
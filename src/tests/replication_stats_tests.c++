@@ -0,0 +1,95 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <sim/simulator.h++>
+#include <stats/replication_stats.h++>
+#include <stats/streaming_stats.h++>
+#include <util/network_generators.h++>
+#include <util/passenger_generator.h++>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+bool close_to(double lhs, double rhs) {
+	return std::abs(lhs - rhs) < 1e-9;
+}
+
+::stats::SampleStatistics make_sample_statistics(const std::vector<double>& samples) {
+	::stats::SampleStatistics result;
+	for (const auto& sample : samples) {
+		result.add(sample);
+	}
+	return result;
+}
+
+} // end anonymous namespace
+
+TEST_CASE(sample_statistics_of_known_samples) {
+	const auto stats = make_sample_statistics({9, 2, 5, 4, 7, 4, 5, 4});
+
+	CHECK_EQUAL(stats.size(), 8u);
+	CHECK(close_to(stats.mean(), 5));
+	CHECK(close_to(stats.standardDeviation(), std::sqrt(32.0 / 7)));
+
+	const auto half_width = 1.96 * std::sqrt(32.0 / 7) / std::sqrt(8.0);
+	CHECK(close_to(stats.confidenceInterval95().first, 5 - half_width));
+	CHECK(close_to(stats.confidenceInterval95().second, 5 + half_width));
+}
+
+TEST_CASE(sample_statistics_quantiles) {
+	// sorted, this is 1 to 11, so the quantile at i/10 is i + 1
+	const auto stats = make_sample_statistics({7, 3, 11, 1, 9, 5, 2, 10, 4, 8, 6});
+	for (int i = 0; i <= 10; ++i) {
+		CHECK_EQUAL(stats.quantile(i / 10.0), i + 1);
+	}
+
+	// nearest rank, rounding half way up
+	const auto four = make_sample_statistics({40, 10, 30, 20});
+	CHECK_EQUAL(four.quantile(0), 10);
+	CHECK_EQUAL(four.quantile(0.5), 30);
+	CHECK_EQUAL(four.quantile(0.3), 20);
+	CHECK_EQUAL(four.quantile(1), 40);
+
+	CHECK_THROWS(four.quantile(1.5), std::invalid_argument);
+	CHECK_THROWS(four.quantile(-0.1), std::invalid_argument);
+}
+
+TEST_CASE(sample_statistics_of_few_samples) {
+	const ::stats::SampleStatistics none;
+	CHECK_EQUAL(none.mean(), 0);
+	CHECK_EQUAL(none.standardDeviation(), 0);
+	CHECK_EQUAL(none.quantile(0.5), 0);
+	CHECK(none.confidenceInterval95() == std::make_pair(0.0, 0.0));
+
+	const auto one = make_sample_statistics({3});
+	CHECK_EQUAL(one.mean(), 3);
+	CHECK_EQUAL(one.standardDeviation(), 0);
+	CHECK_EQUAL(one.quantile(0.9), 3);
+}
+
+TEST_CASE(streaming_run_summary_counts_each_passenger_once) {
+	const ::tests::NetworkScenario scenario(::util::NetworkTopology::GRID, 25);
+
+	for (const auto& mode : {::sim::SimulationMode::FIXED_STEP, ::sim::SimulationMode::EVENT_DRIVEN}) {
+		const auto passenger_generators = PassengerGeneratorFactory(1, scenario.demand).sample();
+		auto sim_handle = ::sim::instantiate_simulator(&passenger_generators, scenario.schedule, scenario.tn, mode);
+		::stats::StreamingPassengerStats streaming_stats(*scenario.tn);
+		streaming_stats.observe(sim_handle);
+
+		// keeping exited passengers, so they are in the list and were seen by streaming_stats
+		sim_handle.runForTime(100, 0.3);
+
+		const auto from_histories = ::stats::summarize_run(sim_handle);
+		const auto from_streaming = ::stats::summarize_run(sim_handle, streaming_stats);
+		CHECK(from_histories.num_passengers_exited > 0);
+		CHECK(from_histories.num_passengers_entered > from_histories.num_passengers_exited);
+		CHECK_EQUAL(from_streaming.num_passengers_entered, from_histories.num_passengers_entered);
+		CHECK_EQUAL(from_streaming.num_passengers_exited, from_histories.num_passengers_exited);
+		CHECK(close_to(from_streaming.mean_waiting_time, from_histories.mean_waiting_time));
+		CHECK(close_to(from_streaming.mean_time_on_trains, from_histories.mean_time_on_trains));
+	}
+}
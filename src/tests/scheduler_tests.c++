@@ -0,0 +1,122 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <parsing/input_parser.h++>
+#include <util/metrics.h++>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * One line per route, like "r1 B1->B2->B3 @0,4", with the departure times of its
+ * first two trains
+ */
+std::vector<std::string> describe_schedule(const ::algo::Schedule& sch, const TrackNetwork& tn) {
+	std::vector<std::string> result;
+	for (const auto& route : sch.getTrainRoutes()) {
+		std::ostringstream os;
+		os << route.getID() << ' ';
+		bool first = true;
+		for (const auto& vertex : route.getPath()) {
+			os << (first ? "" : "->") << tn.getVertexName(vertex);
+			first = false;
+		}
+		os << " @" << route.makeTrainFromIndex(0).getDepartureTime() << ',' << route.makeTrainFromIndex(1).getDepartureTime();
+		result.push_back(os.str());
+	}
+	return result;
+}
+
+/**
+ * Schedules data_file_name (in data/) and checks that it comes out exactly as
+ * expected. The expected schedules are the ones from before the schedulers
+ * were sped up, so that any changes to their output are deliberate.
+ */
+void check_schedule_of(const std::string& data_file_name, const std::vector<std::string>& expected) {
+	std::ifstream is(TEST_DATA_DIR + data_file_name);
+	CHECK(is.is_open());
+	const auto data = ::parsing::input::parse_data(is);
+	CHECK(std::get<2>(data));
+
+	const auto& tn = std::get<0>(data);
+	const auto described = describe_schedule(::algo::schedule(tn, std::get<1>(data)), tn);
+
+	CHECK_EQUAL(described.size(), expected.size());
+	for (size_t i = 0; i != expected.size(); ++i) {
+		CHECK_EQUAL(described[i], expected[i]);
+	}
+}
+
+} // end anonymous namespace
+
+// complex_linear01.dot is left out, as its passengers don't parse
+
+TEST_CASE(schedule_of_complex_grid01) {
+	check_schedule_of("complex_grid01.dot", {
+		"r0 A4->B4->B3->B2->A2->B2->B3->B4->A4 @0,9",
+		"r1 B1->B2->C2->D2->E2->D2->C2->B2->B3->B4->B5 @0,11",
+	});
+}
+
+TEST_CASE(schedule_of_simple_branching01) {
+	check_schedule_of("simple_branching01.dot", {
+		"r0 A->B->C0->D0->E->F->G0 @0,7",
+		"r1 A->B->C0->D0->E->F->G1 @0,7",
+	});
+}
+
+TEST_CASE(schedule_of_simple_cross01) {
+	check_schedule_of("simple_cross01.dot", {
+		"r0 A1->B1->C->D1->E1 @0,5",
+		"r1 A2->B2->C->D2->E2 @0,5",
+	});
+}
+
+TEST_CASE(schedule_of_simple_grid01) {
+	check_schedule_of("simple_grid01.dot", {
+		"r0 A4->B4->C4->D4->D3->D2->C2->B2->A2 @0,9",
+		"r1 E2->D2->C2->B2->B3->B4->B5 @0,7",
+	});
+}
+
+TEST_CASE(schedule_of_simple_grid02) {
+	check_schedule_of("simple_grid02.dot", {
+		"r0 B1->B2 @0,2",
+		"r1 E2->D2->C2->B2->B3->B4->C4->D4 @0,8",
+	});
+}
+
+TEST_CASE(schedule_of_simple_linear01) {
+	check_schedule_of("simple_linear01.dot", {
+		"r0 A->B->C->D->E->F->Z @0,7",
+	});
+}
+
+TEST_CASE(schedule_of_simple_linear02) {
+	check_schedule_of("simple_linear02.dot", {
+		"r0 A->B->C->D->E->F->Z @0,7",
+	});
+}
+
+/**
+ * Coalescing keeps what it found out about each pair of trains until one of them
+ * changes, so most pairs should only have to be compared once.
+ */
+TEST_CASE(coalescing_reuses_pair_evaluations) {
+	metrics::reset();
+	metrics::enable();
+	const ::tests::NetworkScenario scenario(::util::NetworkTopology::BRANCHING, 256);
+	metrics::enable(false);
+
+	const auto num_evaluations = metrics::get(metrics::Counter::COALESCING_PAIR_EVALUATIONS);
+	const auto num_reused = metrics::get(metrics::Counter::COALESCING_PAIRS_REUSED);
+	CHECK(num_evaluations > 0);
+	// without keeping them, every one reused would have been compared again
+	CHECK(num_reused > 0);
+	CHECK(num_reused * 2 > num_evaluations);
+}
@@ -0,0 +1,145 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <sim/simulator.h++>
+#include <util/network_generators.h++>
+#include <util/passenger_generator.h++>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using PassengerKey = std::pair<std::string, TrackNetwork::Time>; // name & start time, as IDs depend on spawn order
+
+struct PassengerHistory {
+	::sim::SimTime time_of_exit;
+	::algo::PassengerRoutes::RouteType path;
+
+	bool operator==(const PassengerHistory& rhs) const {
+		if (time_of_exit != rhs.time_of_exit || path.size() != rhs.path.size()) {
+			return false;
+		}
+		for (size_t i = 0; i != path.size(); ++i) {
+			if (path[i].getLocation() != rhs.path[i].getLocation() || path[i].getTime() != rhs.path[i].getTime()) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+struct RunResults {
+	std::map<PassengerKey, PassengerHistory> exited;
+	std::vector<PassengerKey> still_in_system;
+	std::vector<::sim::SimTime> observer_call_times;
+
+	RunResults() : exited(), still_in_system(), observer_call_times() { }
+};
+
+const ::sim::SimTime OBSERVER_PERIOD = 7;
+
+/**
+ * Simulate scenario for the total of times_to_run, calling runForTime once for each.
+ */
+RunResults run_scenario(
+	const ::tests::NetworkScenario& scenario,
+	::sim::SimulationMode mode,
+	const std::vector<::sim::SimTime>& times_to_run,
+	::sim::SimTime step_size,
+	bool keep_exited_passengers
+) {
+	const auto passenger_generators = PassengerGeneratorFactory(1, scenario.demand).sample();
+	auto sim_handle = ::sim::instantiate_simulator(&passenger_generators, scenario.schedule, scenario.tn, mode);
+	sim_handle.setKeepExitedPassengers(keep_exited_passengers);
+
+	RunResults results;
+	sim_handle.registerPassengerExitObserver([&](const Passenger& passenger, const ::sim::SimTime& time_of_exit, const auto& path) {
+		const auto inserted = results.exited.emplace(
+			PassengerKey(passenger.getName(), passenger.getStartTime()),
+			PassengerHistory{time_of_exit, path}
+		).second;
+		if (!inserted) {
+			::tests::fail(__FILE__, __LINE__, [&](auto&& str) { str << "passenger " << passenger << " exited twice"; });
+		}
+	});
+
+	sim_handle.registerObserver([&]() {
+		results.observer_call_times.push_back(sim_handle.getCurrentTime());
+		return true;
+	}, OBSERVER_PERIOD);
+
+	for (const auto& time_to_run : times_to_run) {
+		sim_handle.runForTime(time_to_run, step_size);
+	}
+
+	for (const auto& id_and_passenger : sim_handle.getPassengerList()) {
+		const auto& passenger = id_and_passenger.second;
+		const PassengerKey key(passenger.getName(), passenger.getStartTime());
+		if (results.exited.find(key) == results.exited.end()) {
+			results.still_in_system.push_back(key);
+		}
+	}
+	std::sort(results.still_in_system.begin(), results.still_in_system.end());
+
+	return results;
+}
+
+void check_same_results(const RunResults& fixed_step, const RunResults& event_driven) {
+	for (const auto& key_and_history : fixed_step.exited) {
+		const auto& key = key_and_history.first;
+		const auto find_result = event_driven.exited.find(key);
+		if (find_result == event_driven.exited.end() || !(find_result->second == key_and_history.second)) {
+			::tests::fail(__FILE__, __LINE__, [&](auto&& str) {
+				str << "passenger " << key.first << '@' << key.second << " has a different history, or didn't exit, in EVENT_DRIVEN mode";
+			});
+		}
+	}
+	CHECK_EQUAL(fixed_step.exited.size(), event_driven.exited.size());
+	CHECK(fixed_step.still_in_system == event_driven.still_in_system);
+
+	// the periods count from the same time in both modes, however the run is split up
+	CHECK(fixed_step.observer_call_times == event_driven.observer_call_times);
+	CHECK(fixed_step.observer_call_times.empty() == false);
+	for (size_t i = 0; i != fixed_step.observer_call_times.size(); ++i) {
+		CHECK_EQUAL(fixed_step.observer_call_times[i], OBSERVER_PERIOD * (i + 1));
+	}
+}
+
+void check_modes_match(::util::NetworkTopology topology, size_t size) {
+	const ::tests::NetworkScenario scenario(topology, size);
+
+	for (const auto& step_size : {0.3, 0.7, 1.0}) {
+		const auto fixed_step = run_scenario(scenario, ::sim::SimulationMode::FIXED_STEP, {100}, step_size, true);
+		CHECK(fixed_step.exited.empty() == false);
+		check_same_results(fixed_step, run_scenario(scenario, ::sim::SimulationMode::EVENT_DRIVEN, {100}, step_size, true));
+	}
+
+	// stopping and starting, or forgetting exited passengers, shouldn't change anything either
+	const auto in_one_go = run_scenario(scenario, ::sim::SimulationMode::EVENT_DRIVEN, {100}, 1, true);
+	check_same_results(in_one_go, run_scenario(scenario, ::sim::SimulationMode::FIXED_STEP, {33.3, 16.7, 50}, 0.3, false));
+	check_same_results(in_one_go, run_scenario(scenario, ::sim::SimulationMode::EVENT_DRIVEN, {33.3, 16.7, 50}, 1, false));
+}
+
+} // end anonymous namespace
+
+TEST_CASE(simulation_modes_match_on_grid) {
+	check_modes_match(::util::NetworkTopology::GRID, 25);
+}
+
+TEST_CASE(simulation_modes_match_on_linear) {
+	check_modes_match(::util::NetworkTopology::LINEAR, 12);
+}
+
+TEST_CASE(simulation_modes_match_on_branching) {
+	check_modes_match(::util::NetworkTopology::BRANCHING, 30);
+}
+
+TEST_CASE(simulation_modes_match_on_cross) {
+	check_modes_match(::util::NetworkTopology::CROSS, 20);
+}
@@ -0,0 +1,186 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <parsing/snapshot.h++>
+#include <util/network_generators.h++>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+
+/**
+ * A file name that is unique, and removed on destruction
+ */
+class TempFile {
+public:
+	TempFile() : file_name(std::string(P_tmpdir) + "/train-sch-tests-XXXXXX") {
+		const int fd = mkstemp(&file_name[0]);
+		if (fd == -1) {
+			throw std::runtime_error("couldn't make a temporary file");
+		}
+		close(fd);
+	}
+	~TempFile() { unlink(file_name.c_str()); }
+
+	TempFile(const TempFile&) = delete;
+	TempFile& operator=(const TempFile&) = delete;
+
+	const std::string& name() const { return file_name; }
+private:
+	std::string file_name;
+};
+
+std::string read_file(const std::string& file_name) {
+	std::ifstream is(file_name, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& file_name, const std::string& contents) {
+	std::ofstream os(file_name, std::ios::binary | std::ios::trunc);
+	os.write(contents.data(), contents.size());
+}
+
+template<typename T>
+T read_at(const std::string& contents, size_t offset) {
+	T value;
+	std::memcpy(&value, contents.data() + offset, sizeof(T));
+	return value;
+}
+
+template<typename T>
+void write_at(std::string& contents, size_t offset, T value) {
+	std::memcpy(&contents[offset], &value, sizeof(T));
+}
+
+// where things are in the file, from the layout in snapshot.c++
+const size_t VERSION_OFFSET = 8;
+const size_t EDGES_SECTION_OFFSET = 56;
+const size_t ROUTES_SECTION_OFFSET = 72;
+const size_t START_OFFSETS_SECTION_OFFSET = 104;
+const size_t ROUTE_RECORD_SIZE = 48;
+const size_t ROUTE_ID_OFFSET = 0;
+const size_t ROUTE_REPEAT_TIME_OFFSET = 8;
+const size_t EDGE_SOURCE_OFFSET = 0;
+
+struct SavedSnapshot {
+	::tests::NetworkScenario scenario;
+	const TrackNetwork& tn;
+	const ::algo::Schedule& sch;
+	TempFile file;
+	std::string contents;
+
+	SavedSnapshot()
+		: scenario(::util::NetworkTopology::GRID, 36, 0.1)
+		, tn(*scenario.tn)
+		, sch(*scenario.schedule)
+		, file()
+		, contents()
+	{
+		::parsing::snapshot::save_snapshot(file.name(), tn, sch);
+		contents = read_file(file.name());
+	}
+
+	/**
+	 * Loading a copy with modify applied should fail
+	 */
+	template<typename FUNC>
+	bool rejectsModified(FUNC&& modify) const {
+		auto modified = contents;
+		modify(modified);
+		TempFile modified_file;
+		write_file(modified_file.name(), modified);
+		try {
+			::parsing::snapshot::Snapshot snapshot(modified_file.name());
+		} catch (const std::runtime_error&) {
+			return true;
+		}
+		return false;
+	}
+};
+
+} // end anonymous namespace
+
+TEST_CASE(snapshot_round_trip) {
+	const SavedSnapshot saved;
+	CHECK(saved.sch.getNumTrainRoutes() > 1);
+
+	const ::parsing::snapshot::Snapshot snapshot(saved.file.name());
+	CHECK(snapshot.matches(saved.tn));
+
+	// the network that comes back should save to exactly the same bytes
+	const auto loaded_tn = snapshot.makeTrackNetwork();
+	CHECK(snapshot.matches(loaded_tn));
+	CHECK_EQUAL(num_vertices(loaded_tn.g()), num_vertices(saved.tn.g()));
+	for (const auto& v : make_iterable(vertices(saved.tn.g()))) {
+		CHECK_EQUAL(loaded_tn.getVertexName(v), saved.tn.getVertexName(v));
+	}
+
+	const auto loaded_sch = snapshot.makeSchedule(saved.tn);
+	CHECK_EQUAL(loaded_sch.getName(), saved.sch.getName());
+	CHECK_EQUAL(loaded_sch.getNumTrainRoutes(), saved.sch.getNumTrainRoutes());
+	for (const auto& route : saved.sch.getTrainRoutes()) {
+		const auto& loaded_route = loaded_sch.getTrainRoute(route.getID());
+		CHECK(loaded_route.getID() == route.getID());
+		CHECK(loaded_route.getPath() == route.getPath());
+		CHECK(loaded_route.getStartOffsets() == route.getStartOffsets());
+		CHECK_EQUAL(loaded_route.getRepeatTime(), route.getRepeatTime());
+	}
+
+	TempFile resaved_file;
+	::parsing::snapshot::save_snapshot(resaved_file.name(), loaded_tn, loaded_sch);
+	CHECK(read_file(resaved_file.name()) == saved.contents);
+}
+
+TEST_CASE(snapshot_is_only_for_its_network) {
+	const SavedSnapshot saved;
+	const ::parsing::snapshot::Snapshot snapshot(saved.file.name());
+	const auto other_tn = ::util::make_network(::util::NetworkTopology::LINEAR, 36);
+
+	CHECK(snapshot.matches(other_tn) == false);
+	CHECK_THROWS(snapshot.makeSchedule(other_tn), std::invalid_argument);
+}
+
+TEST_CASE(snapshot_rejects_corrupt_files) {
+	const SavedSnapshot saved;
+	const auto routes_offset = read_at<uint64_t>(saved.contents, ROUTES_SECTION_OFFSET);
+	const auto edges_offset = read_at<uint64_t>(saved.contents, EDGES_SECTION_OFFSET);
+	const auto start_offsets_offset = read_at<uint64_t>(saved.contents, START_OFFSETS_SECTION_OFFSET);
+
+	// the unmodified one is fine
+	CHECK(saved.rejectsModified([](auto&) { }) == false);
+
+	CHECK(saved.rejectsModified([](auto& contents) { contents[0] = 'X'; }));
+	CHECK(saved.rejectsModified([](auto& contents) { write_at<uint32_t>(contents, VERSION_OFFSET, ::parsing::snapshot::FORMAT_VERSION + 1); }));
+	CHECK(saved.rejectsModified([](auto& contents) { contents.resize(contents.size() / 2); }));
+	CHECK(saved.rejectsModified([](auto& contents) { contents.resize(16); }));
+	CHECK(saved.rejectsModified([](auto& contents) { write_at<uint64_t>(contents, ROUTES_SECTION_OFFSET, 3); }));
+
+	CHECK(saved.rejectsModified([&](auto& contents) {
+		write_at<uint64_t>(contents, edges_offset + EDGE_SOURCE_OFFSET, std::numeric_limits<uint64_t>::max());
+	}));
+	CHECK(saved.rejectsModified([&](auto& contents) {
+		write_at<uint32_t>(contents, routes_offset + ROUTE_RECORD_SIZE + ROUTE_ID_OFFSET, 0);
+	}));
+	CHECK(saved.rejectsModified([&](auto& contents) {
+		write_at<int64_t>(contents, routes_offset + ROUTE_REPEAT_TIME_OFFSET, 0);
+	}));
+	CHECK(saved.rejectsModified([&](auto& contents) {
+		write_at<int64_t>(contents, routes_offset + ROUTE_REPEAT_TIME_OFFSET, int64_t(std::numeric_limits<TrackNetwork::Time>::max()) + 1);
+	}));
+	CHECK(saved.rejectsModified([&](auto& contents) {
+		write_at<int64_t>(contents, start_offsets_offset, int64_t(std::numeric_limits<TrackNetwork::Time>::min()) - 1);
+	}));
+
+	CHECK(saved.rejectsModified([](auto& contents) { contents.clear(); }));
+	CHECK_THROWS(::parsing::snapshot::Snapshot("/nonexistent/train-sch-snapshot"), std::runtime_error);
+}
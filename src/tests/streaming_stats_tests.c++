@@ -0,0 +1,133 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <sim/simulator.h++>
+#include <stats/replication_stats.h++>
+#include <stats/streaming_stats.h++>
+#include <util/network_generators.h++>
+#include <util/passenger_generator.h++>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+TEST_CASE(histogram_quantiles_match_sample_statistics_on_integers) {
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> value_distribution(0, 60);
+
+	for (const int num_values : {1, 2, 5, 100, 1001}) {
+		::stats::Histogram histogram;
+		::stats::SampleStatistics samples;
+		for (int i = 0; i < num_values; ++i) {
+			const double value = value_distribution(rng);
+			histogram.add(value);
+			samples.add(value);
+		}
+
+		CHECK_EQUAL(histogram.size(), samples.size());
+		CHECK(std::abs(histogram.mean() - samples.mean()) < 1e-9);
+		CHECK_EQUAL(histogram.max(), samples.quantile(1));
+		for (int i = 0; i <= 20; ++i) {
+			CHECK_EQUAL(histogram.quantile(i / 20.0), samples.quantile(i / 20.0));
+		}
+	}
+}
+
+TEST_CASE(histogram_quantiles_are_bin_bottoms) {
+	::stats::Histogram histogram(2);
+	for (const double value : {0.5, 1.9, 2.0, 3.5, 7.25, 9.99}) {
+		histogram.add(value);
+	}
+
+	CHECK_EQUAL(histogram.size(), 6u);
+	CHECK_EQUAL(histogram.max(), 9.99);
+	CHECK(std::abs(histogram.total() - 25.14) < 1e-9);
+	CHECK(std::abs(histogram.mean() - 25.14 / 6) < 1e-9);
+
+	// ranks 0 to 5 are in bins [0,2), [0,2), [2,4), [2,4), [6,8) and [8,10)
+	CHECK_EQUAL(histogram.quantile(0), 0);
+	CHECK_EQUAL(histogram.quantile(0.2), 0);
+	CHECK_EQUAL(histogram.quantile(0.4), 2);
+	CHECK_EQUAL(histogram.quantile(0.6), 2);
+	CHECK_EQUAL(histogram.quantile(0.8), 6);
+	CHECK_EQUAL(histogram.quantile(1), 8);
+}
+
+TEST_CASE(histogram_edge_cases) {
+	::stats::Histogram histogram;
+	CHECK_EQUAL(histogram.size(), 0u);
+	CHECK_EQUAL(histogram.mean(), 0);
+	CHECK_EQUAL(histogram.quantile(0.5), 0);
+
+	histogram.add(-3);
+	histogram.add(4);
+	CHECK_EQUAL(histogram.total(), 4);
+	CHECK_EQUAL(histogram.quantile(0), 0);
+	CHECK_EQUAL(histogram.quantile(1), 4);
+
+	CHECK_THROWS(histogram.quantile(1.01), std::invalid_argument);
+	CHECK_THROWS(histogram.quantile(-0.5), std::invalid_argument);
+}
+
+TEST_CASE(passenger_records_quote_names) {
+	TrackNetwork::BackingGraphType g;
+	TrackNetwork::OffNodeDataPropertyMap off_node_data;
+	for (const auto& name : {"Main St, North", "say \"hi\""}) {
+		const auto vertex = add_vertex(g);
+		off_node_data[vertex].name = name;
+	}
+	const TrackNetwork tn(std::move(g), std::move(off_node_data));
+
+	auto records_os = std::make_unique<std::ostringstream>();
+	const auto& records = *records_os;
+	::stats::StreamingPassengerStats streaming_stats(tn, std::move(records_os));
+
+	const StatisticalPassenger statistical_passenger("a,b", 0, 1, 1);
+	const Passenger passenger(&statistical_passenger, ::util::make_id<PassengerID>(0), 2);
+	streaming_stats.addPassenger(passenger, 9, {
+		{LocationID(tn.getStationIDByVertexID(0)), 2},
+		{LocationID(::util::make_id<::algo::TrainID>(::util::make_id<::algo::RouteID>(0), 0)), 4},
+		{LocationID(tn.getStationIDByVertexID(1)), 9},
+	});
+
+	CHECK_EQUAL(records.str(),
+		"passenger,entry,exit,start_time,boarding_time,exit_time,waiting_time,time_on_trains,num_trains\n"
+		"\"a,b\",\"Main St, North\",\"say \"\"hi\"\"\",2,4,9,2,5,1\n"
+	);
+}
+
+TEST_CASE(long_streaming_runs_use_bounded_memory) {
+	const ::tests::NetworkScenario scenario(::util::NetworkTopology::GRID, 25);
+
+	for (const auto& mode : {::sim::SimulationMode::FIXED_STEP, ::sim::SimulationMode::EVENT_DRIVEN}) {
+		const auto passenger_generators = PassengerGeneratorFactory(1, scenario.demand).sample();
+		auto sim_handle = ::sim::instantiate_simulator(&passenger_generators, scenario.schedule, scenario.tn, mode);
+		::stats::StreamingPassengerStats streaming_stats(*scenario.tn);
+		streaming_stats.observe(sim_handle);
+		sim_handle.setKeepExitedPassengers(false);
+
+		// what is kept shouldn't grow with the time simulated, so after the first little
+		// while, it should never be much more than it was then
+		size_t max_passengers_early = 0;
+		size_t max_cached_routes_early = 0;
+		for (int i = 0; i != 200; ++i) {
+			sim_handle.runForTime(100, 1);
+			const auto num_passengers = sim_handle.getPassengerList().size();
+			const auto num_cached_routes = sim_handle.getNumCachedRoutes();
+			if (i < 10) {
+				max_passengers_early = std::max(max_passengers_early, num_passengers);
+				max_cached_routes_early = std::max(max_cached_routes_early, num_cached_routes);
+			} else {
+				CHECK(num_passengers <= 2 * max_passengers_early);
+				CHECK(num_cached_routes <= 2 * max_cached_routes_early);
+			}
+		}
+
+		CHECK(max_cached_routes_early > 0);
+		CHECK(streaming_stats.getOverall().size() > 100 * max_passengers_early);
+	}
+}
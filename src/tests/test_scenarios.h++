@@ -0,0 +1,62 @@
+#ifndef TESTS__TEST_SCENARIOS_HPP
+#define TESTS__TEST_SCENARIOS_HPP
+
+#include <algo/scheduler.h++>
+#include <util/network_generators.h++>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * Things to test with, that more than one test file uses
+ */
+namespace tests {
+
+/**
+ * A generated network, some random demand on it, with a source for about every other
+ * station, and what the scheduler makes for that. Shared, as the simulator wants.
+ */
+struct NetworkScenario {
+	std::shared_ptr<TrackNetwork> tn;
+	std::vector<StatisticalPassenger> demand;
+	std::shared_ptr<const ::algo::Schedule> schedule;
+
+	NetworkScenario(::util::NetworkTopology topology, size_t size, double passenger_rate = 0.3, uint64_t seed = 1)
+		: tn(std::make_shared<TrackNetwork>(::util::make_network(topology, size)))
+		, demand(::util::make_demand(*tn, size / 2, passenger_rate, seed))
+		, schedule(std::make_shared<::algo::Schedule>(::algo::schedule(*tn, demand)))
+	{ }
+};
+
+/**
+ * The routes that the scheduler makes for some random demand on tn, but with random
+ * start offsets (unsorted, and sometimes repeated) and repeat times.
+ */
+inline ::algo::Schedule make_scrambled_schedule(const TrackNetwork& tn, uint64_t seed) {
+	const auto scheduled = ::algo::schedule(tn, ::util::make_demand(tn, 12, 0.1, seed));
+
+	std::mt19937_64 rand_gen(seed);
+	std::vector<::algo::TrainRoute> train_routes;
+	for (const auto& route : scheduled.getTrainRoutes()) {
+		const TrackNetwork::Time repeat_time = std::uniform_int_distribution<TrackNetwork::Time>(1, 20)(rand_gen);
+		std::vector<TrackNetwork::Time> start_offsets(std::uniform_int_distribution<size_t>(1, 4)(rand_gen));
+		for (auto& start_offset : start_offsets) {
+			start_offset = std::uniform_int_distribution<TrackNetwork::Time>(0, repeat_time - 1)(rand_gen);
+		}
+		train_routes.emplace_back(
+			::util::make_id<::algo::RouteID>(train_routes.size()),
+			route.getPath(),
+			std::move(start_offsets),
+			repeat_time,
+			tn
+		);
+	}
+
+	return ::algo::Schedule("scrambled", std::move(train_routes));
+}
+
+} // end namespace tests
+
+#endif /* TESTS__TEST_SCENARIOS_HPP */
@@ -0,0 +1,80 @@
+#ifndef TESTS__TEST_UTILS_HPP
+#define TESTS__TEST_UTILS_HPP
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Just enough of a test harness to not need another dependency. TEST_CASE
+ * defines a function that tests_main.c++ will run, and the CHECK macros
+ * throw a TestFailure saying where and what, if what they check is false.
+ */
+namespace tests {
+
+class TestFailure : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+struct TestCase {
+	std::string name;
+	std::function<void()> function;
+};
+
+/**
+ * Every TEST_CASE in the executable, in the order they were registered
+ */
+std::vector<TestCase>& get_test_cases();
+
+struct TestRegistration {
+	TestRegistration(const std::string& name, std::function<void()> function) {
+		get_test_cases().push_back(TestCase{name, std::move(function)});
+	}
+};
+
+template<typename FUNC>
+[[noreturn]] void fail(const char* file, int line, FUNC&& describe) {
+	std::ostringstream os;
+	os << file << ':' << line << ": ";
+	describe(os);
+	throw TestFailure(os.str());
+}
+
+} // end namespace tests
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const ::tests::TestRegistration name##_registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			::tests::fail(__FILE__, __LINE__, [&](auto&& str) { str << "CHECK(" #condition ") failed"; }); \
+		} \
+	} while (false)
+
+#define CHECK_EQUAL(lhs, rhs) \
+	do { \
+		const auto& check_lhs = (lhs); \
+		const auto& check_rhs = (rhs); \
+		if (!(check_lhs == check_rhs)) { \
+			::tests::fail(__FILE__, __LINE__, [&](auto&& str) { \
+				str << "CHECK_EQUAL(" #lhs ", " #rhs ") failed: " << check_lhs << " != " << check_rhs; \
+			}); \
+		} \
+	} while (false)
+
+#define CHECK_THROWS(expression, exception_type) \
+	do { \
+		bool check_threw = false; \
+		try { (void)(expression); } catch (const exception_type&) { check_threw = true; } \
+		if (!check_threw) { \
+			::tests::fail(__FILE__, __LINE__, [&](auto&& str) { str << "CHECK_THROWS(" #expression ", " #exception_type ") didn't throw"; }); \
+		} \
+	} while (false)
+
+#endif /* TESTS__TEST_UTILS_HPP */
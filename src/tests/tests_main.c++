@@ -0,0 +1,45 @@
+#include <tests/test_utils.h++>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+/**
+ * Runs every TEST_CASE linked in, or just the ones named on the command line,
+ * and exits with non-zero status if any failed.
+ */
+
+namespace tests {
+
+std::vector<TestCase>& get_test_cases() {
+	static std::vector<TestCase> test_cases;
+	return test_cases;
+}
+
+} // end namespace tests
+
+int main(int argc, char const** argv) {
+	const std::vector<std::string> names_to_run(argv + 1, argv + argc);
+
+	size_t num_run = 0;
+	size_t num_failed = 0;
+
+	for (const auto& test_case : ::tests::get_test_cases()) {
+		if (names_to_run.empty() == false && std::find(names_to_run.begin(), names_to_run.end(), test_case.name) == names_to_run.end()) {
+			continue;
+		}
+
+		num_run += 1;
+		try {
+			test_case.function();
+			std::cout << "[  OK  ] " << test_case.name << '\n';
+		} catch (const std::exception& e) {
+			num_failed += 1;
+			std::cout << "[ FAIL ] " << test_case.name << ": " << e.what() << '\n';
+		}
+	}
+
+	std::cout << num_run - num_failed << " of " << num_run << " tests passed\n";
+
+	return num_failed == 0 ? 0 : 1;
+}
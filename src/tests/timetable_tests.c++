@@ -0,0 +1,91 @@
+#include <tests/test_scenarios.h++>
+#include <tests/test_utils.h++>
+
+#include <algo/scheduler.h++>
+#include <algo/timetable.h++>
+#include <util/network_generators.h++>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+namespace {
+
+/**
+ * Check every stop against the TrainRoutes directly, and the first train at
+ * or after a range of times against trying every train that could be it.
+ */
+void check_timetable_against_scan(const TrackNetwork& tn, const ::algo::Schedule& sch) {
+	const ::algo::Timetable timetable(sch, tn);
+
+	CHECK(timetable.isCompiledFrom(sch));
+	CHECK_EQUAL(timetable.getNumVertices(), num_vertices(tn.g()));
+
+	size_t num_stops = 0;
+	for (const auto& route : sch.getTrainRoutes()) {
+		const auto& path = route.getPath();
+		const auto num_trains_to_scan = (60 / route.getRepeatTime() + 3) * route.getStartOffsets().size();
+
+		for (size_t position = 0; position != path.size(); ++position) {
+			const auto stop = timetable.getFirstStopOf(route.getID()) + position;
+			num_stops += 1;
+
+			CHECK(timetable.getRouteOf(stop) == route.getID());
+			CHECK_EQUAL(timetable.getVertexOf(stop), path[position]);
+			const auto stops_here = timetable.getStopsAt(path[position]);
+			CHECK(std::find(stops_here.begin(), stops_here.end(), stop) != stops_here.end());
+			CHECK_EQUAL(
+				timetable.getNextStop(stop),
+				position + 1 == path.size() ? ::algo::Timetable::INVALID_STOP : stop + 1
+			);
+
+			std::vector<TrackNetwork::Time> arrival_times;
+			for (::algo::TrainIndex train_index = 0; train_index != num_trains_to_scan; ++train_index) {
+				const auto train = route.makeTrainFromIndex(train_index);
+				arrival_times.push_back(train.getExpectedArrivalTime(path.begin() + position, tn));
+				CHECK_EQUAL(timetable.getDepartureTime(route.getID(), train_index), train.getDepartureTime());
+				CHECK_EQUAL(timetable.getArrivalTime(stop, train_index), arrival_times.back());
+			}
+
+			for (TrackNetwork::Time t = -5; t <= 40; ++t) {
+				auto scan_result = std::numeric_limits<TrackNetwork::Time>::max();
+				for (const auto& arrival_time : arrival_times) {
+					if (arrival_time >= t) {
+						scan_result = std::min(scan_result, arrival_time);
+					}
+				}
+				// trains with the same arrival time are equally good, so just compare times
+				const auto found = timetable.getFirstTrainArrivingAtOrAfter(stop, t);
+				CHECK_EQUAL(timetable.getArrivalTime(stop, found), scan_result);
+			}
+		}
+	}
+
+	CHECK_EQUAL(timetable.getNumStops(), num_stops);
+}
+
+} // end anonymous namespace
+
+TEST_CASE(timetable_matches_scan_on_grid) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::GRID, 36);
+	for (uint64_t seed = 1; seed <= 5; ++seed) {
+		check_timetable_against_scan(tn, ::tests::make_scrambled_schedule(tn, seed));
+	}
+}
+
+TEST_CASE(timetable_matches_scan_on_branching) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::BRANCHING, 30);
+	for (uint64_t seed = 1; seed <= 5; ++seed) {
+		check_timetable_against_scan(tn, ::tests::make_scrambled_schedule(tn, seed));
+	}
+}
+
+TEST_CASE(timetable_rejects_routes_that_dont_repeat) {
+	const auto tn = ::util::make_network(::util::NetworkTopology::LINEAR, 4);
+	std::vector<::algo::TrainRoute> train_routes;
+	train_routes.emplace_back(::util::make_id<::algo::RouteID>(0), std::vector<TrackNetwork::NodeID>{0, 1, 2}, std::vector<TrackNetwork::Time>{0}, 0, tn);
+	const ::algo::Schedule sch("no repeats", std::move(train_routes));
+	const ::algo::Timetable timetable(sch, tn);
+
+	CHECK_THROWS(timetable.getFirstTrainArrivingAtOrAfter(timetable.getFirstStopOf(::util::make_id<::algo::RouteID>(0)), 0), std::invalid_argument);
+}
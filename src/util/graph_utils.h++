@@ -8,6 +8,11 @@
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/property_map/property_map.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -52,6 +57,144 @@ auto getEdgePropertyMapCopy(
 	return edge_prop_map_copy;
 }
 
+namespace detail {
+	/**
+	 * If the edge from a vertex at from_distance to one at to_distance, with weight,
+	 * is the last edge of a shortest route to the latter, and gets strictly closer
+	 */
+	template<typename DISTANCE>
+	bool is_strictly_closer_predecessor(DISTANCE from_distance, DISTANCE weight, DISTANCE to_distance) {
+		return from_distance < to_distance && from_distance + weight == to_distance;
+	}
+}
+
+/**
+ * Computes shortest path trees with dijkstra_shortest_paths, and holds on to
+ * the result. Keeps its buffers between searches, so that doing many searches
+ * on the same graph doesn't keep allocating them.
+ * After computeTreeFrom(start, weight_map), getRouteTo(end) is the same
+ * route that get_shortest_route(start, end, g, weight_map) gives.
+ *
+ * Of several equally short routes, the one picked is the one where each vertex
+ * is reached from the lowest indexed vertex that it can be (and that is strictly
+ * closer to the start). So, it doesn't depend on the order of the search, and
+ * ShortestPathOracle picks the same one.
+ */
+template<typename GRAPH, typename DISTANCE = double>
+class ShortestPathTree {
+public:
+	using VertexDescriptor = typename boost::graph_traits<GRAPH>::vertex_descriptor;
+
+	ShortestPathTree(const GRAPH& g)
+		: g(&g)
+		, start()
+		, predecessors(num_vertices(g))
+		, distances(num_vertices(g))
+		, colours(num_vertices(g))
+		, lowest_predecessors(num_vertices(g))
+	{ }
+
+	ShortestPathTree(const ShortestPathTree&) = default;
+	ShortestPathTree(ShortestPathTree&&) = default;
+	ShortestPathTree& operator=(const ShortestPathTree&) = default;
+	ShortestPathTree& operator=(ShortestPathTree&&) = default;
+
+	/**
+	 * Replace the current tree with the one rooted at start, using weight_map
+	 */
+	template<typename WEIGHT_MAP>
+	void computeTreeFrom(VertexDescriptor start, const WEIGHT_MAP& weight_map) {
+		static_assert(
+			std::is_same<typename boost::property_traits<WEIGHT_MAP>::value_type, DISTANCE>::value,
+			"distances should be computed with the type of the weights"
+		);
+
+		this->start = start;
+
+		const auto index_map = get(boost::vertex_index, *g);
+		dijkstra_shortest_paths(
+			*g, start,
+			boost::make_iterator_property_map(predecessors.begin(), index_map),
+			boost::make_iterator_property_map(distances.begin(), index_map),
+			weight_map,
+			index_map,
+			std::less<DISTANCE>(),
+			std::plus<DISTANCE>(),
+			std::numeric_limits<DISTANCE>::max(),
+			DISTANCE(),
+			boost::make_dijkstra_visitor(boost::null_visitor()),
+			boost::make_iterator_property_map(colours.begin(), index_map)
+		);
+
+		pickLowestIndexPredecessors(weight_map);
+	}
+
+	VertexDescriptor getStart() const { return start; }
+
+	bool reaches(VertexDescriptor end) const {
+		return end == start || predecessors[end] != end;
+	}
+
+	DISTANCE getDistanceTo(VertexDescriptor end) const { return distances[end]; }
+
+	/**
+	 * The route from the start of the tree to end, including both. If end
+	 * can't be reached, the route is just the start vertex.
+	 */
+	std::vector<VertexDescriptor> getRouteTo(VertexDescriptor end) const {
+		std::vector<VertexDescriptor> route;
+		for (
+			auto vi = end;
+			vi != start;
+			vi = predecessors[vi]
+		) {
+			if (route.empty() == false && route.back() == vi) {
+				route.clear();
+				break;
+			} else {
+				route.push_back(vi);
+			}
+		}
+
+		route.push_back(start);
+		util::reverse(route);
+
+		return route;
+	}
+
+private:
+	const GRAPH* g;
+	VertexDescriptor start;
+	std::vector<VertexDescriptor> predecessors;
+	std::vector<DISTANCE> distances;
+	std::vector<boost::default_color_type> colours;
+	std::vector<VertexDescriptor> lowest_predecessors;
+
+	/**
+	 * dijkstra_shortest_paths keeps the first predecessor it finds, which depends on
+	 * the order of its queue, so replace each with the lowest indexed one instead.
+	 * A vertex only reachable over weights of zero keeps the one it had.
+	 */
+	template<typename WEIGHT_MAP>
+	void pickLowestIndexPredecessors(const WEIGHT_MAP& weight_map) {
+		const auto none = std::numeric_limits<VertexDescriptor>::max();
+		std::fill(lowest_predecessors.begin(), lowest_predecessors.end(), none);
+		for (const auto& e : make_iterable(edges(*g))) {
+			const auto from = source(e, *g);
+			const auto to = target(e, *g);
+			if (from < lowest_predecessors[to] && detail::is_strictly_closer_predecessor(distances[from], get(weight_map, e), distances[to])) {
+				lowest_predecessors[to] = from;
+			}
+		}
+
+		for (const auto& v : make_iterable(vertices(*g))) {
+			if (lowest_predecessors[v] != none) {
+				predecessors[v] = lowest_predecessors[v];
+			}
+		}
+	}
+};
+
 template<typename GRAPH, typename WEIGHT_MAP>
 auto get_shortest_route(
 	typename boost::graph_traits<GRAPH>::vertex_descriptor start,
@@ -59,33 +202,448 @@ auto get_shortest_route(
 	const GRAPH& g,
 	const WEIGHT_MAP& weight_map
 ) {
+	ShortestPathTree<GRAPH, typename boost::property_traits<WEIGHT_MAP>::value_type> tree(g);
+	tree.computeTreeFrom(start, weight_map);
+	return tree.getRouteTo(end);
+}
+
+/**
+ * The shortest route for each (start, end) pair in start_end_pairs, in the same
+ * order. Only computes one tree for each distinct start vertex, so this is much
+ * cheaper than calling get_shortest_route for each pair when starts repeat.
+ */
+template<typename GRAPH, typename WEIGHT_MAP, typename START_END_PAIRS>
+auto get_shortest_routes(
+	const START_END_PAIRS& start_end_pairs,
+	const GRAPH& g,
+	const WEIGHT_MAP& weight_map
+) {
+	using VertexDescriptor = typename boost::graph_traits<GRAPH>::vertex_descriptor;
+
+	std::vector<size_t> query_order(start_end_pairs.size());
+	std::iota(query_order.begin(), query_order.end(), 0);
+	std::stable_sort(query_order.begin(), query_order.end(), [&](const auto& lhs, const auto& rhs) {
+		return start_end_pairs[lhs].first < start_end_pairs[rhs].first;
+	});
+
+	std::vector<std::vector<VertexDescriptor>> routes(start_end_pairs.size());
+	ShortestPathTree<GRAPH, typename boost::property_traits<WEIGHT_MAP>::value_type> tree(g);
+	bool have_tree = false;
+
+	for (const auto& iquery : query_order) {
+		const auto& start_end_pair = start_end_pairs[iquery];
+		if (!have_tree || tree.getStart() != start_end_pair.first) {
+			tree.computeTreeFrom(start_end_pair.first, weight_map);
+			have_tree = true;
+		}
+		routes[iquery] = tree.getRouteTo(start_end_pair.second);
+	}
+
+	return routes;
+}
+
+/**
+ * Answers point to point shortest route queries with A*, using ALT (A*, Landmarks
+ * and the Triangle inequality) lower bounds as the heuristic. Construction picks
+ * a few landmark vertices spread out over the graph, and stores the distances
+ * from and to each of them. That is O(number of landmarks * vertices) memory and
+ * two dijkstra searches per landmark, independent of how many queries follow.
+ * A query only expands the vertices that could be on a shortest route to its
+ * end, instead of growing a whole tree, and never resets per vertex buffers.
+ *
+ * The bounds come from the weights given at construction, but a query may use
+ * another weight map, as long as none of its weights are smaller (eg. the
+ * inflated weights of Scheduler2). The bounds are still valid then, just looser.
+ *
+ * Of several equally short routes, this picks the same one as ShortestPathTree.
+ * For that, a query keeps going until everything that could be on any shortest
+ * route to the end has been expanded, and then picks the lowest indexed of the
+ * predecessors of each vertex on the way back. Weights of zero are the exception:
+ * a vertex only reachable over those may be reached from a different one.
+ *
+ * Queries reuse buffers, so use one oracle per thread.
+ */
+template<typename GRAPH, typename DISTANCE = double>
+class ShortestPathOracle {
+public:
 	using VertexDescriptor = typename boost::graph_traits<GRAPH>::vertex_descriptor;
+	using EdgeDescriptor = typename boost::graph_traits<GRAPH>::edge_descriptor;
+
+	static constexpr size_t DEFAULT_NUM_LANDMARKS = 8;
+	static constexpr DISTANCE UNREACHABLE = std::numeric_limits<DISTANCE>::max();
+
+	template<typename WEIGHT_MAP>
+	ShortestPathOracle(const GRAPH& g, const WEIGHT_MAP& weight_map, size_t num_landmarks = DEFAULT_NUM_LANDMARKS);
+
+	ShortestPathOracle(const ShortestPathOracle&) = default;
+	ShortestPathOracle(ShortestPathOracle&&) = default;
+	ShortestPathOracle& operator=(const ShortestPathOracle&) = default;
+	ShortestPathOracle& operator=(ShortestPathOracle&&) = default;
+
+	const std::vector<VertexDescriptor>& getLandmarks() const { return landmarks; }
+
+	/**
+	 * How many whole graph dijkstra searches construction took
+	 */
+	size_t getNumPreprocessingSearches() const { return num_preprocessing_searches; }
+
+	/**
+	 * How many vertices the most recent query expanded
+	 */
+	size_t getNumExpandedByLastQuery() const { return num_expanded_by_last_query; }
+
+	/**
+	 * A lower bound on the distance from start to end, or UNREACHABLE if the
+	 * landmarks show that there is no route at all. Just a few lookups.
+	 */
+	DISTANCE getLowerBound(VertexDescriptor start, VertexDescriptor end) const;
+
+	/**
+	 * The shortest route from start to end, including both, using the weights given
+	 * at construction. If end can't be reached, the route is just the start vertex,
+	 * same as get_shortest_route.
+	 */
+	std::vector<VertexDescriptor> getRoute(VertexDescriptor start, VertexDescriptor end) {
+		search(start, end, [&](size_t iedge) { return out_weights[iedge]; });
+		return makeRouteTo(start, end, [&](size_t iedge) { return in_weights[iedge]; });
+	}
+
+	/**
+	 * Same as above, but using weight_map, which must not be less than the weights
+	 * given at construction anywhere.
+	 */
+	template<typename WEIGHT_MAP>
+	std::vector<VertexDescriptor> getRoute(VertexDescriptor start, VertexDescriptor end, const WEIGHT_MAP& weight_map) {
+		search(start, end, [&](size_t iedge) -> DISTANCE { return get(weight_map, out_edge_descs[iedge]); });
+		return makeRouteTo(start, end, [&](size_t iedge) -> DISTANCE { return get(weight_map, in_edge_descs[iedge]); });
+	}
+
+	/**
+	 * The length of the shortest route from start to end using the weights given
+	 * at construction, or UNREACHABLE
+	 */
+	DISTANCE getDistance(VertexDescriptor start, VertexDescriptor end) {
+		search(start, end, [&](size_t iedge) { return out_weights[iedge]; });
+		return isReached(end) ? distances[end] : UNREACHABLE;
+	}
+
+private:
+	/**
+	 * Edges stored flat, grouped by vertex, so that neither the searches here nor
+	 * the heuristic has to go through the graph
+	 */
+	struct FlatAdjacency {
+		std::vector<size_t> offsets;
+		std::vector<VertexDescriptor> targets;
+
+		FlatAdjacency() : offsets(), targets() { }
+	};
+
+	using HeapElement = std::pair<DISTANCE, VertexDescriptor>;
+
+	size_t num_vertices_;
+	FlatAdjacency out_adjacency;
+	std::vector<EdgeDescriptor> out_edge_descs;
+	std::vector<DISTANCE> out_weights;
+	FlatAdjacency in_adjacency;
+	std::vector<EdgeDescriptor> in_edge_descs;
+	std::vector<DISTANCE> in_weights;
+
+	std::vector<VertexDescriptor> landmarks;
+	// indexed by [vertex * number of landmarks + landmark index]
+	std::vector<DISTANCE> distances_from_landmarks;
+	std::vector<DISTANCE> distances_to_landmarks;
+	// taken off of every bound used as the heuristic, so that rounding can't make one too big
+	DISTANCE bound_slack;
+	size_t num_preprocessing_searches;
+
+	// query buffers. A vertex's entries are only valid if its stamp is the current one
+	std::vector<DISTANCE> distances;
+	std::vector<VertexDescriptor> predecessors;
+	std::vector<uint> reached_stamps;
+	std::vector<uint> closed_stamps;
+	uint current_stamp;
+	std::vector<HeapElement> heap;
+	size_t num_expanded_by_last_query;
+
+	bool isReached(VertexDescriptor v) const { return reached_stamps[v] == current_stamp; }
+
+	static DISTANCE saturatingAdd(DISTANCE lhs, DISTANCE rhs) {
+		return (lhs == UNREACHABLE || rhs == UNREACHABLE) ? UNREACHABLE : lhs + rhs;
+	}
+
+	/**
+	 * Plain dijkstra over adjacency & weights, from source, into result
+	 */
+	void computeAllDistances(
+		VertexDescriptor source,
+		const FlatAdjacency& adjacency,
+		const std::vector<DISTANCE>& weights,
+		std::vector<DISTANCE>& result
+	);
+
+	template<typename WEIGHT_FUNC>
+	void search(VertexDescriptor start, VertexDescriptor end, WEIGHT_FUNC&& weight_of);
+
+	template<typename IN_WEIGHT_FUNC>
+	std::vector<VertexDescriptor> makeRouteTo(VertexDescriptor start, VertexDescriptor end, IN_WEIGHT_FUNC&& in_weight_of) const;
+};
 
-	std::vector<VertexDescriptor> predecessors(num_vertices(g));
-
-	dijkstra_shortest_paths(
-		g, start,
-		predecessor_map(
-			boost::make_iterator_property_map(
-				predecessors.begin(),
-				get(boost::vertex_index, g)
-			)
-		).weight_map(
-			weight_map
-		)
+template<typename GRAPH, typename DISTANCE>
+template<typename WEIGHT_MAP>
+ShortestPathOracle<GRAPH, DISTANCE>::ShortestPathOracle(const GRAPH& g, const WEIGHT_MAP& weight_map, size_t num_landmarks)
+	: num_vertices_(num_vertices(g))
+	, out_adjacency()
+	, out_edge_descs()
+	, out_weights()
+	, in_adjacency()
+	, in_edge_descs()
+	, in_weights()
+	, landmarks()
+	, distances_from_landmarks()
+	, distances_to_landmarks()
+	, bound_slack(0)
+	, num_preprocessing_searches(0)
+	, distances(num_vertices_)
+	, predecessors(num_vertices_)
+	, reached_stamps(num_vertices_, 0)
+	, closed_stamps(num_vertices_, 0)
+	, current_stamp(0)
+	, heap()
+	, num_expanded_by_last_query(0)
+{
+	static_assert(
+		std::is_same<typename boost::property_traits<WEIGHT_MAP>::value_type, DISTANCE>::value,
+		"distances should be computed with the type of the weights"
 	);
 
+	{
+		std::vector<size_t> in_degrees(num_vertices_ + 1, 0);
+		out_adjacency.offsets.push_back(0);
+		for (const auto& v : make_iterable(vertices(g))) {
+			for (const auto& e : make_iterable(out_edges(v, g))) {
+				out_adjacency.targets.push_back(target(e, g));
+				out_edge_descs.push_back(e);
+				out_weights.push_back(get(weight_map, e));
+				in_degrees[target(e, g) + 1] += 1;
+			}
+			out_adjacency.offsets.push_back(out_adjacency.targets.size());
+		}
+
+		std::partial_sum(in_degrees.begin(), in_degrees.end(), in_degrees.begin());
+		in_adjacency.offsets = in_degrees;
+		in_adjacency.targets.resize(out_adjacency.targets.size());
+		in_edge_descs.resize(out_adjacency.targets.size());
+		in_weights.resize(out_adjacency.targets.size());
+		for (size_t v = 0; v != num_vertices_; ++v) {
+			for (size_t iedge = out_adjacency.offsets[v]; iedge != out_adjacency.offsets[v+1]; ++iedge) {
+				const auto slot = in_degrees[out_adjacency.targets[iedge]]++;
+				in_adjacency.targets[slot] = v;
+				in_edge_descs[slot] = out_edge_descs[iedge];
+				in_weights[slot] = out_weights[iedge];
+			}
+		}
+	}
+
+	num_landmarks = std::min(num_landmarks, num_vertices_);
+	distances_from_landmarks.resize(num_landmarks * num_vertices_);
+	distances_to_landmarks.resize(num_landmarks * num_vertices_);
+
+	// Pick landmarks greedily, each as far as possible from the ones already picked,
+	// so that they end up around the edges of the graph, where they give the best bounds.
+	// Vertices that no landmark is connected to count as the furthest of all.
+	std::vector<DISTANCE> closest_landmark_distance(num_vertices_, UNREACHABLE);
+	std::vector<DISTANCE> from_landmark(num_vertices_);
+	std::vector<DISTANCE> to_landmark(num_vertices_);
+	if (num_landmarks != 0) {
+		// start at the vertex furthest from an arbitrary one
+		computeAllDistances(0, out_adjacency, out_weights, from_landmark);
+		VertexDescriptor next_landmark = 0;
+		for (size_t v = 0; v != num_vertices_; ++v) {
+			if (from_landmark[v] != UNREACHABLE && from_landmark[v] > from_landmark[next_landmark]) {
+				next_landmark = v;
+			}
+		}
+		landmarks.push_back(next_landmark);
+	}
+
+	DISTANCE longest_landmark_distance = 0;
+	for (size_t ilandmark = 0; ilandmark != landmarks.size(); ++ilandmark) {
+		computeAllDistances(landmarks[ilandmark], out_adjacency, out_weights, from_landmark);
+		computeAllDistances(landmarks[ilandmark], in_adjacency, in_weights, to_landmark);
+
+		VertexDescriptor furthest = 0;
+		for (size_t v = 0; v != num_vertices_; ++v) {
+			distances_from_landmarks[v * num_landmarks + ilandmark] = from_landmark[v];
+			distances_to_landmarks[v * num_landmarks + ilandmark] = to_landmark[v];
+			for (const auto& distance : {from_landmark[v], to_landmark[v]}) {
+				if (distance != UNREACHABLE) {
+					longest_landmark_distance = std::max(longest_landmark_distance, distance);
+				}
+			}
+			closest_landmark_distance[v] = std::min(
+				closest_landmark_distance[v],
+				saturatingAdd(from_landmark[v], to_landmark[v])
+			);
+			if (closest_landmark_distance[v] > closest_landmark_distance[furthest]) {
+				furthest = v;
+			}
+		}
+
+		if (landmarks.size() != num_landmarks && closest_landmark_distance[furthest] != 0) {
+			landmarks.push_back(furthest);
+		}
+	}
+
+	distances_from_landmarks.resize(landmarks.size() * num_vertices_);
+	distances_to_landmarks.resize(landmarks.size() * num_vertices_);
+
+	// the bounds are differences of sums, so they can be off by a few roundings of the
+	// longest distance. Far more than that is taken off, but it is still a tiny fraction.
+	bound_slack = longest_landmark_distance * 1e-9;
+}
+
+template<typename GRAPH, typename DISTANCE>
+DISTANCE ShortestPathOracle<GRAPH, DISTANCE>::getLowerBound(VertexDescriptor start, VertexDescriptor end) const {
+	const auto num_landmarks = landmarks.size();
+	const auto* from_start = distances_from_landmarks.data() + start * num_landmarks;
+	const auto* from_end   = distances_from_landmarks.data() + end * num_landmarks;
+	const auto* to_start   = distances_to_landmarks.data() + start * num_landmarks;
+	const auto* to_end     = distances_to_landmarks.data() + end * num_landmarks;
+
+	DISTANCE bound = 0;
+	for (size_t ilandmark = 0; ilandmark != num_landmarks; ++ilandmark) {
+		// d(start,end) >= d(L,end) - d(L,start)
+		if (from_start[ilandmark] != UNREACHABLE) {
+			if (from_end[ilandmark] == UNREACHABLE) {
+				return UNREACHABLE; // L reaches start, but not end, so start can't either
+			} else if (from_end[ilandmark] > from_start[ilandmark]) {
+				bound = std::max(bound, from_end[ilandmark] - from_start[ilandmark]);
+			}
+		}
+		// d(start,end) >= d(start,L) - d(end,L)
+		if (to_end[ilandmark] != UNREACHABLE) {
+			if (to_start[ilandmark] == UNREACHABLE) {
+				return UNREACHABLE; // end reaches L, but start doesn't, so start can't reach end
+			} else if (to_start[ilandmark] > to_end[ilandmark]) {
+				bound = std::max(bound, to_start[ilandmark] - to_end[ilandmark]);
+			}
+		}
+	}
+	return bound;
+}
+
+template<typename GRAPH, typename DISTANCE>
+void ShortestPathOracle<GRAPH, DISTANCE>::computeAllDistances(
+	VertexDescriptor source,
+	const FlatAdjacency& adjacency,
+	const std::vector<DISTANCE>& weights,
+	std::vector<DISTANCE>& result
+) {
+	num_preprocessing_searches += 1;
+
+	std::fill(result.begin(), result.end(), UNREACHABLE);
+	heap.clear();
+
+	result[source] = 0;
+	heap.emplace_back(0, source);
+	while (heap.empty() == false) {
+		std::pop_heap(heap.begin(), heap.end(), std::greater<HeapElement>());
+		const auto current = heap.back();
+		heap.pop_back();
+		if (current.first != result[current.second]) {
+			continue; // there was a shorter way here
+		}
+		for (size_t iedge = adjacency.offsets[current.second]; iedge != adjacency.offsets[current.second + 1]; ++iedge) {
+			const auto next = adjacency.targets[iedge];
+			const auto distance = current.first + weights[iedge];
+			if (distance < result[next]) {
+				result[next] = distance;
+				heap.emplace_back(distance, next);
+				std::push_heap(heap.begin(), heap.end(), std::greater<HeapElement>());
+			}
+		}
+	}
+}
+
+template<typename GRAPH, typename DISTANCE>
+template<typename WEIGHT_FUNC>
+void ShortestPathOracle<GRAPH, DISTANCE>::search(VertexDescriptor start, VertexDescriptor end, WEIGHT_FUNC&& weight_of) {
+	current_stamp += 1;
+	if (current_stamp == 0) {
+		// wrapped around, so old stamps could look current
+		std::fill(reached_stamps.begin(), reached_stamps.end(), 0);
+		std::fill(closed_stamps.begin(), closed_stamps.end(), 0);
+		current_stamp = 1;
+	}
+	heap.clear();
+	num_expanded_by_last_query = 0;
+
+	if (getLowerBound(start, end) == UNREACHABLE) {
+		return;
+	}
+
+	reached_stamps[start] = current_stamp;
+	distances[start] = 0;
+	predecessors[start] = start;
+	heap.emplace_back(0, start);
+
+	// Not done when end is expanded, but only once nothing left could be on a route to
+	// it that is just as short, as that may be the route that should be picked.
+	// A vertex can be expanded again if a shorter way to it is found later, because
+	// the bounds can be a bit inconsistent after the slack is taken off.
+	while (heap.empty() == false && (isReached(end) == false || heap.front().first <= distances[end])) {
+		std::pop_heap(heap.begin(), heap.end(), std::greater<HeapElement>());
+		const auto current = heap.back().second;
+		heap.pop_back();
+		if (closed_stamps[current] == current_stamp) {
+			continue; // a stale entry
+		}
+		closed_stamps[current] = current_stamp;
+		num_expanded_by_last_query += 1;
+
+		for (size_t iedge = out_adjacency.offsets[current]; iedge != out_adjacency.offsets[current + 1]; ++iedge) {
+			const auto next = out_adjacency.targets[iedge];
+			const DISTANCE distance = distances[current] + weight_of(iedge);
+			if (isReached(next) && distances[next] <= distance) {
+				continue;
+			}
+			const auto bound = getLowerBound(next, end);
+			if (bound == UNREACHABLE) {
+				continue; // a dead end
+			}
+			reached_stamps[next] = current_stamp;
+			closed_stamps[next] = 0;
+			distances[next] = distance;
+			predecessors[next] = current;
+			heap.emplace_back(distance + (bound > bound_slack ? bound - bound_slack : 0), next);
+			std::push_heap(heap.begin(), heap.end(), std::greater<HeapElement>());
+		}
+	}
+}
+
+template<typename GRAPH, typename DISTANCE>
+template<typename IN_WEIGHT_FUNC>
+auto ShortestPathOracle<GRAPH, DISTANCE>::makeRouteTo(VertexDescriptor start, VertexDescriptor end, IN_WEIGHT_FUNC&& in_weight_of) const -> std::vector<VertexDescriptor> {
 	std::vector<VertexDescriptor> route;
-	for (
-		auto vi = end;
-		vi != start;
-		vi = predecessors[vi]
-	) {
-		if (route.empty() == false && route.back() == vi) {
-			route.clear();
-			break;
-		} else {
+	if (start != end && isReached(end)) {
+		for (auto vi = end; vi != start; ) {
 			route.push_back(vi);
+
+			// the search's predecessor if weights of zero are involved, otherwise the lowest indexed
+			auto predecessor = predecessors[vi];
+			bool found_lowest = false;
+			for (size_t iedge = in_adjacency.offsets[vi]; iedge != in_adjacency.offsets[vi + 1]; ++iedge) {
+				const auto from = in_adjacency.targets[iedge];
+				if (isReached(from)
+					&& (found_lowest == false || from < predecessor)
+					&& detail::is_strictly_closer_predecessor(distances[from], in_weight_of(iedge), distances[vi])
+				) {
+					predecessor = from;
+					found_lowest = true;
+				}
+			}
+			vi = predecessor;
 		}
 	}
 
@@ -95,7 +653,6 @@ auto get_shortest_route(
 	return route;
 }
 
-
 template <typename K, typename V, typename MAPTYPE = std::unordered_map<K,V>>
 class default_map {
 public:
@@ -103,9 +103,9 @@ LevelStream::~LevelStream() {
 
 void LevelStream::flush() {
 	if (enabled()) {
-		src->print(underlying_ss);
+		src->print(*underlying_ss);
+		underlying_ss->clear();
 	}
-	underlying_ss.clear();
 }
 
 void IndentLevel::endIndent() {
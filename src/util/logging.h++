@@ -7,6 +7,7 @@
 #include <bitset>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -66,6 +67,20 @@ namespace DebugLevel {
 	std::pair<Level,bool> getFromString(std::string str);
 	std::string getAsString(Level l);
 
+	/**
+	 * Can l print anything in this build? Builds without DEBUG defined (ie. release)
+	 * compile out everything but INFO, WARN and ERROR, so that the dout calls in
+	 * inner loops cost nothing there.
+	 */
+	constexpr bool isCompiledIn(Level l) {
+#ifdef DEBUG
+		(void)l;
+		return true;
+#else
+		return l == INFO || l == WARN || l == ERROR;
+#endif
+	}
+
 }
 
 using DL = DebugLevel::Level;
@@ -207,12 +222,15 @@ private:
 	friend class IndentingLeveledDebugPrinter;
 
 	IndentingLeveledDebugPrinter* src;
-	std::stringstream underlying_ss;
+
+	// only made if enabled, as a disabled one is made for every
+	// dout(...) call on a level that is off, including in inner loops
+	std::unique_ptr<std::stringstream> underlying_ss;
 
 public:
 	LevelStream(IndentingLeveledDebugPrinter* src)
 		: src(src)
-		, underlying_ss()
+		, underlying_ss(src ? std::make_unique<std::stringstream>() : nullptr)
 	{ }
 
 	LevelStream(const LevelStream&) = default;
@@ -226,13 +244,13 @@ public:
 	template<typename T>
 	IndentLevel indentWithTitle(const T& t);
 
-	bool enabled() { return src != nullptr; }
+	bool enabled() { return src != nullptr && underlying_ss != nullptr; }
 	void flush();
 
 	template<typename T>
 	LevelStream& push_in(const T& t) {
 		if (enabled()) {
-			underlying_ss << t;
+			*underlying_ss << t;
 		}
 		return *this;
 	}
@@ -316,6 +334,18 @@ public:
 
 	void setHighestTitleRank(int level) { highest_title_rank = level; }
 
+	/**
+	 * Hides LevelRedirecter's, so that levels that are compiled out
+	 * are known to be off at compile time.
+	 */
+	LevelStream operator()(const DebugLevel::Level& level) {
+		if (DebugLevel::isCompiledIn(level)) {
+			return LevelRedirecter::operator()(level);
+		} else {
+			return LevelStream(nullptr);
+		}
+	}
+
 private:
 	friend class IndentLevel;
 	friend class LevelStream;
@@ -0,0 +1,213 @@
+#include "metrics.h++"
+
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace metrics {
+
+namespace {
+	const std::array<const char*, static_cast<size_t>(Counter::COUNT)> counter_names {
+		"route_searches",
+		"routes_from_cache",
+		"shortest_path_trees",
+		"shortest_path_queries",
+		"coalescing_passes",
+		"trains_merged",
+		"coalescing_pair_evaluations",
+		"coalescing_pairs_reused",
+		"sim_steps",
+		"sim_events",
+		"passengers_moved",
+	};
+
+	const std::array<const char*, static_cast<size_t>(Distribution::COUNT)> distribution_names {
+		"route_search_expansions",
+		"shortest_path_query_expansions",
+	};
+
+	const std::array<const char*, static_cast<size_t>(Phase::COUNT)> phase_names {
+		"parse",
+		"schedule",
+		"route",
+		"simulate",
+		"report",
+	};
+
+	struct Span {
+		Phase phase;
+		uint thread_number;
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+	};
+
+	// spans are only recorded for whole phases, so a lock is fine
+	std::mutex spans_mutex;
+	std::vector<Span> spans;
+
+	// for making the times in traces small numbers
+	const auto time_origin = std::chrono::steady_clock::now();
+
+	/**
+	 * Small numbers for threads, in the order they first record a span
+	 */
+	uint get_thread_number() {
+		static std::atomic<uint> next_thread_number(0);
+		thread_local const uint thread_number = next_thread_number++;
+		return thread_number;
+	}
+
+	double to_microseconds(std::chrono::steady_clock::duration d) {
+		return std::chrono::duration<double, std::micro>(d).count();
+	}
+} // end anonymous namespace
+
+namespace detail {
+	std::atomic<bool> is_enabled(false);
+	std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)> counters{};
+	std::array<DistributionData, static_cast<size_t>(Distribution::COUNT)> distributions{};
+
+	void record_distribution(DistributionData& data, uint64_t value) {
+		data.count.fetch_add(1, std::memory_order_relaxed);
+		data.sum.fetch_add(value, std::memory_order_relaxed);
+		auto old_max = data.max.load(std::memory_order_relaxed);
+		while (old_max < value && !data.max.compare_exchange_weak(old_max, value, std::memory_order_relaxed)) { }
+	}
+
+	void record_span(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+		const auto thread_number = get_thread_number();
+		std::lock_guard<std::mutex> lock(spans_mutex);
+		spans.push_back(Span{phase, thread_number, start, end});
+	}
+}
+
+void enable(bool enable) {
+	detail::is_enabled.store(enable, std::memory_order_relaxed);
+}
+
+void reset() {
+	for (auto& counter : detail::counters) {
+		counter.store(0, std::memory_order_relaxed);
+	}
+	for (auto& distribution : detail::distributions) {
+		distribution.count.store(0, std::memory_order_relaxed);
+		distribution.sum.store(0, std::memory_order_relaxed);
+		distribution.max.store(0, std::memory_order_relaxed);
+	}
+	std::lock_guard<std::mutex> lock(spans_mutex);
+	spans.clear();
+}
+
+uint64_t get(Counter counter) {
+	return detail::counters[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+std::pair<OutputFormat, bool> get_output_format_from_string(const std::string& str) {
+	if (str == "json") {
+		return { OutputFormat::JSON, true };
+	} else if (str == "chrome-trace") {
+		return { OutputFormat::CHROME_TRACE, true };
+	} else {
+		return { OutputFormat::JSON, false };
+	}
+}
+
+namespace {
+
+void write_json(std::ostream& os, const std::vector<Span>& spans_copy) {
+	os << "{\n";
+
+	os << "\t\"counters\": {";
+	for (size_t i = 0; i != counter_names.size(); ++i) {
+		os << (i == 0 ? "\n" : ",\n") << "\t\t\"" << counter_names[i] << "\": " << detail::counters[i].load();
+	}
+	os << "\n\t},\n";
+
+	os << "\t\"distributions\": {";
+	for (size_t i = 0; i != distribution_names.size(); ++i) {
+		const auto& distribution = detail::distributions[i];
+		const auto count = distribution.count.load();
+		const auto sum = distribution.sum.load();
+		os << (i == 0 ? "\n" : ",\n") << "\t\t\"" << distribution_names[i] << "\": {"
+			<< " \"count\": " << count
+			<< ", \"sum\": " << sum
+			<< ", \"mean\": " << (count == 0 ? 0.0 : sum / static_cast<double>(count))
+			<< ", \"max\": " << distribution.max.load()
+			<< " }";
+	}
+	os << "\n\t},\n";
+
+	// wall time from the start of the first span to the end of the last, so that
+	// phases done on many threads at once aren't over-counted
+	os << "\t\"phases\": {";
+	for (size_t i = 0; i != phase_names.size(); ++i) {
+		size_t count = 0;
+		auto first_start = std::chrono::steady_clock::time_point::max();
+		auto last_end = std::chrono::steady_clock::time_point::min();
+		std::chrono::steady_clock::duration total_duration(0);
+		for (const auto& span : spans_copy) {
+			if (static_cast<size_t>(span.phase) != i) { continue; }
+			count += 1;
+			first_start = std::min(first_start, span.start);
+			last_end = std::max(last_end, span.end);
+			total_duration += span.end - span.start;
+		}
+		const auto wall_time = count == 0 ? std::chrono::steady_clock::duration(0) : last_end - first_start;
+		os << (i == 0 ? "\n" : ",\n") << "\t\t\"" << phase_names[i] << "\": {"
+			<< " \"count\": " << count
+			<< ", \"wall_seconds\": " << std::chrono::duration<double>(wall_time).count()
+			<< ", \"total_seconds\": " << std::chrono::duration<double>(total_duration).count()
+			<< " }";
+	}
+	os << "\n\t}\n";
+
+	os << "}\n";
+}
+
+void write_chrome_trace(std::ostream& os, const std::vector<Span>& spans_copy) {
+	os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	auto last_end = time_origin;
+	for (const auto& span : spans_copy) {
+		os << "{\"name\": \"" << phase_names[static_cast<size_t>(span.phase)] << "\""
+			<< ", \"cat\": \"phase\", \"ph\": \"X\", \"pid\": 0"
+			<< ", \"tid\": " << span.thread_number
+			<< ", \"ts\": " << to_microseconds(span.start - time_origin)
+			<< ", \"dur\": " << to_microseconds(span.end - span.start)
+			<< "},\n";
+		last_end = std::max(last_end, span.end);
+	}
+
+	// the totals, as one counter sample at the end
+	os << "{\"name\": \"counters\", \"ph\": \"C\", \"pid\": 0, \"tid\": 0"
+		<< ", \"ts\": " << to_microseconds(last_end - time_origin)
+		<< ", \"args\": {";
+	for (size_t i = 0; i != counter_names.size(); ++i) {
+		os << (i == 0 ? "" : ", ") << "\"" << counter_names[i] << "\": " << detail::counters[i].load();
+	}
+	os << "}}\n";
+
+	os << "]}\n";
+}
+
+} // end anonymous namespace
+
+void write(std::ostream& os, OutputFormat format) {
+	std::vector<Span> spans_copy;
+	{
+		std::lock_guard<std::mutex> lock(spans_mutex);
+		spans_copy = spans;
+	}
+
+	switch (format) {
+		case OutputFormat::JSON:
+			write_json(os, spans_copy);
+			return;
+		case OutputFormat::CHROME_TRACE:
+			write_chrome_trace(os, spans_copy);
+			return;
+	}
+}
+
+} // end namespace metrics
@@ -0,0 +1,145 @@
+#ifndef UTIL__METRICS_H
+#define UTIL__METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+
+/**
+ * Counters, distributions and phase timers for seeing where the time goes,
+ * without turning on (and wading through) debug output. Everything is off
+ * until enable() is called, and when off, each count/record/timer is just a
+ * relaxed load and a branch. All of it is safe to use from any thread.
+ */
+namespace metrics {
+
+/**
+ * If adding one, make sure to update the names in metrics.c++
+ */
+enum class Counter : uint {
+	ROUTE_SEARCHES,              // passenger routes found by searching the timetable
+	ROUTES_FROM_CACHE,           // passenger routes answered by a RouteTroughScheduleCache instead
+	SHORTEST_PATH_TREES,         // track network shortest path trees computed
+	SHORTEST_PATH_QUERIES,       // point to point queries answered by a ShortestPathOracle
+	COALESCING_PASSES,           // Scheduler3 coalescing iterations
+	TRAINS_MERGED,               // trains gotten rid of by coalescing
+	COALESCING_PAIR_EVALUATIONS, // pairs of trains compared by Scheduler3 coalescing
+	COALESCING_PAIRS_REUSED,     // pairs of trains coalescing didn't have to compare again
+	SIM_STEPS,                   // fixed step simulator steps
+	SIM_EVENTS,                  // event driven simulator events handled
+	PASSENGERS_MOVED,            // passengers moved between a train and a station by the simulator
+
+	COUNT, // please make sure this is at the end
+};
+
+/**
+ * Things recorded once per occurrence, to get a distribution.
+ * If adding one, make sure to update the names in metrics.c++
+ */
+enum class Distribution : uint {
+	ROUTE_SEARCH_EXPANSIONS,        // stations expanded by each passenger route search
+	SHORTEST_PATH_QUERY_EXPANSIONS, // vertices expanded by each ShortestPathOracle query
+
+	COUNT, // please make sure this is at the end
+};
+
+/**
+ * The top level steps of a run, for timing with ScopedTimer.
+ * If adding one, make sure to update the names in metrics.c++
+ */
+enum class Phase : uint {
+	PARSE,
+	SCHEDULE,
+	ROUTE,
+	SIMULATE,
+	REPORT,
+
+	COUNT, // please make sure this is at the end
+};
+
+namespace detail {
+	struct DistributionData {
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+		std::atomic<uint64_t> max;
+	};
+
+	extern std::atomic<bool> is_enabled;
+	extern std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)> counters;
+	extern std::array<DistributionData, static_cast<size_t>(Distribution::COUNT)> distributions;
+
+	void record_distribution(DistributionData& data, uint64_t value);
+	void record_span(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+}
+
+inline bool enabled() { return detail::is_enabled.load(std::memory_order_relaxed); }
+
+/**
+ * Start (or stop) collecting. Doesn't clear what was already collected.
+ */
+void enable(bool enable = true);
+
+/**
+ * Forget everything collected so far
+ */
+void reset();
+
+inline void count(Counter counter, uint64_t amount = 1) {
+	if (enabled()) {
+		detail::counters[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+	}
+}
+
+inline void record(Distribution distribution, uint64_t value) {
+	if (enabled()) {
+		detail::record_distribution(detail::distributions[static_cast<size_t>(distribution)], value);
+	}
+}
+
+uint64_t get(Counter counter);
+
+/**
+ * Times from construction to destruction, and records it as a span of phase.
+ * Spans may nest and overlap, eg. simulations running on several threads.
+ */
+class ScopedTimer {
+public:
+	ScopedTimer(Phase phase)
+		: phase(phase)
+		, is_timing(enabled())
+		, start(is_timing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+	{ }
+
+	~ScopedTimer() {
+		if (is_timing) {
+			detail::record_span(phase, start, std::chrono::steady_clock::now());
+		}
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+private:
+	Phase phase;
+	bool is_timing;
+	std::chrono::steady_clock::time_point start;
+};
+
+enum class OutputFormat {
+	JSON,         // totals of everything
+	CHROME_TRACE, // for chrome://tracing or Perfetto. Every span, and the counter totals at the end
+};
+
+/**
+ * "json" or "chrome-trace". The bool is false if str is neither.
+ */
+std::pair<OutputFormat, bool> get_output_format_from_string(const std::string& str);
+
+void write(std::ostream& os, OutputFormat format);
+
+} // end namespace metrics
+
+#endif /* UTIL__METRICS_H */
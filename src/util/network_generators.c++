@@ -0,0 +1,273 @@
+#include "network_generators.h++"
+
+#include <util/graph_utils.h++>
+#include <util/logging.h++>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+
+namespace util {
+
+namespace {
+	const std::array<std::string, static_cast<size_t>(NetworkTopology::COUNT)> topology_names {
+		"grid",
+		"linear",
+		"branching",
+		"cross",
+	};
+
+	// same spacing as the hand written files in data/
+	const TrackNetwork::CoordType SPACING = 50;
+
+	/**
+	 * Accumulates vertices & edges, then makes a TrackNetwork out of them,
+	 * the same way the input parser does.
+	 */
+	class NetworkBuilder {
+	public:
+		NetworkBuilder()
+			: network()
+			, off_node_data()
+			, next_edge_index(0)
+		{ }
+
+		TrackNetwork::NodeID addVertex(const std::string& name, TrackNetwork::CoordType x, TrackNetwork::CoordType y) {
+			const auto vertex = add_vertex(network);
+			auto& data = off_node_data[vertex];
+			data.name = name;
+			data.location = TrackNetwork::PointType(x, y);
+			return vertex;
+		}
+
+		void addEdge(TrackNetwork::NodeID from, TrackNetwork::NodeID to, TrackNetwork::Weight distance = 1) {
+			add_edge(from, to, TrackNetwork::EdgeProperties(distance, next_edge_index), network);
+			next_edge_index += 1;
+		}
+
+		/**
+		 * Add edges between each consecutive pair of vertices in line
+		 */
+		void addLine(const std::vector<TrackNetwork::NodeID>& line) {
+			for (size_t i = 1; i < line.size(); ++i) {
+				addEdge(line[i-1], line[i]);
+			}
+		}
+
+		TrackNetwork build() {
+			return TrackNetwork(std::move(network), std::move(off_node_data));
+		}
+
+	private:
+		TrackNetwork::BackingGraphType network;
+		TrackNetwork::OffNodeDataPropertyMap off_node_data;
+		TrackNetwork::EdgeIndex next_edge_index;
+	};
+
+	TrackNetwork make_grid(size_t side_length) {
+		NetworkBuilder builder;
+		std::vector<std::vector<TrackNetwork::NodeID>> grid(side_length);
+		for (size_t row = 0; row != side_length; ++row) {
+			for (size_t col = 0; col != side_length; ++col) {
+				grid[row].push_back(builder.addVertex(
+					"r" + std::to_string(row) + "c" + std::to_string(col),
+					SPACING * (col + 1), SPACING * (row + 1)
+				));
+			}
+		}
+
+		// even rows go right, odd rows go left, even columns go down, odd columns go up
+		for (size_t row = 0; row != side_length; ++row) {
+			auto line = grid[row];
+			if (row % 2 == 1) {
+				std::reverse(begin(line), end(line));
+			}
+			builder.addLine(line);
+		}
+		for (size_t col = 0; col != side_length; ++col) {
+			std::vector<TrackNetwork::NodeID> line;
+			for (size_t row = 0; row != side_length; ++row) {
+				line.push_back(grid[row][col]);
+			}
+			if (col % 2 == 1) {
+				std::reverse(begin(line), end(line));
+			}
+			builder.addLine(line);
+		}
+
+		return builder.build();
+	}
+
+	TrackNetwork make_linear(size_t size) {
+		NetworkBuilder builder;
+		std::vector<TrackNetwork::NodeID> line;
+		for (size_t i = 0; i != size; ++i) {
+			line.push_back(builder.addVertex("s" + std::to_string(i), SPACING * i, 0));
+		}
+		builder.addLine(line);
+		return builder.build();
+	}
+
+	TrackNetwork make_branching(size_t main_line_length) {
+		NetworkBuilder builder;
+		std::vector<TrackNetwork::NodeID> main_line;
+		for (size_t i = 0; i != main_line_length; ++i) {
+			main_line.push_back(builder.addVertex("m" + std::to_string(i), SPACING * i, 0));
+		}
+		builder.addLine(main_line);
+
+		// the bypasses are longer than the part of the main line they go around
+		for (size_t i = 1; i + 3 < main_line_length; i += 4) {
+			const auto bypass0 = builder.addVertex("b" + std::to_string(i) + "_0", SPACING * (i + 1), SPACING);
+			const auto bypass1 = builder.addVertex("b" + std::to_string(i) + "_1", SPACING * (i + 2), SPACING);
+			builder.addEdge(main_line[i], bypass0, 2);
+			builder.addEdge(bypass0, bypass1, 1);
+			builder.addEdge(bypass1, main_line[i + 3], 2);
+		}
+
+		// the final fork
+		for (int branch : { 0, 1 }) {
+			const auto end_vertex = builder.addVertex(
+				"t" + std::to_string(branch), SPACING * main_line_length, SPACING * (branch == 0 ? -1 : 1)
+			);
+			builder.addEdge(main_line.back(), end_vertex);
+		}
+
+		return builder.build();
+	}
+
+	TrackNetwork make_cross(size_t arm_length) {
+		NetworkBuilder builder;
+		const auto centre = builder.addVertex("c", 0, 0);
+
+		// one line goes west to east, the other north to south
+		std::vector<TrackNetwork::NodeID> horizontal;
+		std::vector<TrackNetwork::NodeID> vertical;
+		for (size_t i = arm_length; i != 0; --i) {
+			horizontal.push_back(builder.addVertex("w" + std::to_string(i), -SPACING * i, 0));
+			vertical.push_back(builder.addVertex("n" + std::to_string(i), 0, -SPACING * i));
+		}
+		horizontal.push_back(centre);
+		vertical.push_back(centre);
+		for (size_t i = 1; i <= arm_length; ++i) {
+			horizontal.push_back(builder.addVertex("e" + std::to_string(i), SPACING * i, 0));
+			vertical.push_back(builder.addVertex("s" + std::to_string(i), 0, SPACING * i));
+		}
+
+		builder.addLine(horizontal);
+		builder.addLine(vertical);
+
+		// the shunt
+		builder.addEdge(horizontal.front(), vertical.front());
+
+		return builder.build();
+	}
+} // end anonymous namespace
+
+std::pair<NetworkTopology, bool> get_topology_from_string(const std::string& str) {
+	// linear search is probably fine
+	for (size_t i = 0; i != topology_names.size(); ++i) {
+		if (str == topology_names[i]) {
+			return { static_cast<NetworkTopology>(i), true };
+		}
+	}
+	return { NetworkTopology::COUNT, false };
+}
+
+const std::string& get_topology_name(NetworkTopology topology) {
+	return topology_names.at(static_cast<size_t>(topology));
+}
+
+std::vector<NetworkTopology> get_all_topologies() {
+	std::vector<NetworkTopology> result;
+	for (size_t i = 0; i != static_cast<size_t>(NetworkTopology::COUNT); ++i) {
+		result.push_back(static_cast<NetworkTopology>(i));
+	}
+	return result;
+}
+
+TrackNetwork make_network(NetworkTopology topology, size_t size) {
+	if (size == 0) {
+		::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
+			str << "can't make a " << get_topology_name(topology) << " network of size 0";
+		});
+	}
+
+	// every shape gets at least one of whatever it is made of
+	switch (topology) {
+		case NetworkTopology::GRID:
+			return make_grid(std::max<size_t>(1, std::lround(std::sqrt(size))));
+		case NetworkTopology::LINEAR:
+			return make_linear(size);
+		case NetworkTopology::BRANCHING:
+			return make_branching(std::max<size_t>(1, size*2/3));
+		case NetworkTopology::CROSS:
+			return make_cross(std::max<size_t>(1, size/4));
+		case NetworkTopology::COUNT:
+			break;
+	}
+
+	::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
+		str << "unknown network topology " << static_cast<int>(topology);
+	});
+	return TrackNetwork();
+}
+
+std::vector<StatisticalPassenger> make_demand(
+	const TrackNetwork& tn,
+	size_t num_passengers,
+	StatisticalPassenger::AverageRate average_rate,
+	uint64_t seed
+) {
+	std::mt19937_64 rand_gen(seed);
+	const auto num_stations = num_vertices(tn.g());
+	std::uniform_int_distribution<TrackNetwork::NodeID> vertex_dist(0, num_stations == 0 ? 0 : num_stations - 1);
+
+	// what each entry can reach, computed the first time it is picked
+	std::unordered_map<TrackNetwork::NodeID, std::vector<TrackNetwork::NodeID>> reachable_from;
+	ShortestPathTree<TrackNetwork::BackingGraphType, TrackNetwork::Weight> tree(tn.g());
+	const auto& get_reachable_from = [&](TrackNetwork::NodeID entry) -> const std::vector<TrackNetwork::NodeID>& {
+		auto find_results = reachable_from.find(entry);
+		if (find_results != end(reachable_from)) {
+			return find_results->second;
+		}
+		tree.computeTreeFrom(entry, boost::get(&TrackNetwork::EdgeProperties::weight, tn.g()));
+		std::vector<TrackNetwork::NodeID> reachable;
+		for (const auto& vertex : make_iterable(vertices(tn.g()))) {
+			if (vertex != entry && tree.reaches(vertex)) {
+				reachable.push_back(vertex);
+			}
+		}
+		return reachable_from.emplace(entry, std::move(reachable)).first->second;
+	};
+
+	std::vector<StatisticalPassenger> result;
+	size_t num_dead_ends = 0;
+	while (result.size() != num_passengers) {
+		const auto entry = vertex_dist(rand_gen);
+		const auto& reachable = get_reachable_from(entry);
+		if (reachable.empty()) {
+			num_dead_ends += 1;
+			if (num_dead_ends == 100*num_stations + 100) {
+				::util::print_and_throw<std::invalid_argument>([&](auto&& str) {
+					str << "can't find anywhere for passengers to go in this network";
+				});
+			}
+			continue;
+		}
+
+		const auto exit = reachable[std::uniform_int_distribution<size_t>(0, reachable.size() - 1)(rand_gen)];
+		result.emplace_back(
+			"p" + std::to_string(result.size()) + "_" + tn.getVertexName(entry) + "_" + tn.getVertexName(exit),
+			entry,
+			exit,
+			average_rate
+		);
+	}
+
+	return result;
+}
+
+} // end namespace util
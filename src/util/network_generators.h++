@@ -0,0 +1,69 @@
+#ifndef UTIL__NETWORK_GENERATORS_H
+#define UTIL__NETWORK_GENERATORS_H
+
+#include <util/passenger.h++>
+#include <util/track_network.h++>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Synthetic track networks and passenger demand of any size, for benchmarking
+ * and testing without having to write .dot files. Everything here is
+ * deterministic: the same arguments always give the same network and demand.
+ */
+namespace util {
+
+/**
+ * Shapes of network. Each is scaled so that it has about size stations, so that
+ * the same size means about the same amount of work for each of them.
+ * All edges have distance 1 unless noted.
+ *  GRID      - a sqrt(size) x sqrt(size) square of stations, rows and columns are
+ *              alternating one way lines, like data/simple_grid02.dot
+ *  LINEAR    - one one way line of size stations
+ *  BRANCHING - a main line of 2/3 size stations, with a slower two station bypass
+ *              around every fourth group of stations, and a fork at the end,
+ *              like data/simple_branching01.dot
+ *  CROSS     - two one way lines of size/2 + 1 stations that share their middle station,
+ *              with a shunt between their first stations, like data/simple_cross01.dot
+ * If adding one, make sure to update the names in network_generators.c++
+ */
+enum class NetworkTopology {
+	GRID,
+	LINEAR,
+	BRANCHING,
+	CROSS,
+
+	COUNT, // please make sure this is at the end
+};
+
+/**
+ * "grid", "linear", "branching" or "cross". The bool is false if str is none of them.
+ */
+std::pair<NetworkTopology, bool> get_topology_from_string(const std::string& str);
+const std::string& get_topology_name(NetworkTopology topology);
+std::vector<NetworkTopology> get_all_topologies();
+
+/**
+ * Make a network of the given shape, with about size stations.
+ * Throws std::invalid_argument if size is 0.
+ */
+TrackNetwork make_network(NetworkTopology topology, size_t size);
+
+/**
+ * Pick num_passengers random (entry, exit) pairs from tn where the exit can be
+ * reached from the entry, each leaving at average_rate.
+ * Throws std::invalid_argument if no vertex can reach any other.
+ */
+std::vector<StatisticalPassenger> make_demand(
+	const TrackNetwork& tn,
+	size_t num_passengers,
+	StatisticalPassenger::AverageRate average_rate,
+	uint64_t seed
+);
+
+} // end namespace util
+
+#endif /* UTIL__NETWORK_GENERATORS_H */
@@ -18,24 +18,19 @@ PassengerGenerator::PassengerGenerator(const StatisticalPassenger& statpsgr, See
 	, rand_gen(seed)
 { }
 
-auto PassengerGenerator::nextPassengerAfter(Time t) const -> Time {
-	const auto avg_rate = statpsgr.getAverageRate();
+auto PassengerGenerator::DepartureCursor::nextPassengerAfter(Time t) -> Time {
+	const auto avg_rate = src->statpsgr.getAverageRate();
 	if (avg_rate == 0) {
 		return std::numeric_limits<decltype(t)>::max();
 	} else if (avg_rate == 1) {
 		return t + 1;
 	}
 
-	RandGen rand_gen_l(seed);
+	// geometric_distribution keeps no state between draws, so a new one draws the same gaps
 	std::geometric_distribution<Time> geom_dist(avg_rate);
 
-	Time prev = 0;
-
-	while (true) {
-		if (prev > t) {
-			return prev;
-		}
-		const auto num = geom_dist(rand_gen_l);
-		prev += num;
+	while (last_departure <= t) {
+		last_departure += geom_dist(rand_gen);
 	}
+	return last_departure;
 }
@@ -5,6 +5,8 @@
 #include <util/generator.h++>
 #include <util/passenger.h++>
 
+#include <algorithm>
+#include <cmath>
 #include <random>
 
 #include <boost/operators.hpp>
@@ -34,16 +36,50 @@ public:
 	using RandGen = std::mt19937_64;
 	using Time = TrackNetwork::Time;
 
+	/**
+	 * Goes through the departure times of a PassengerGenerator in order, keeping
+	 * the state of the random number generator and the last departure, so that
+	 * getting the next one only draws the gaps since the last one, instead of
+	 * replaying them all from time 0.
+	 * Gives the same times as nextPassengerAfter and firstPassengerAtOrAfter, as
+	 * long as the times asked about never go backwards.
+	 */
+	class DepartureCursor {
+	public:
+		DepartureCursor(const PassengerGenerator& src)
+			: src(&src)
+			, rand_gen(src.seed)
+			, last_departure(0)
+		{ }
+
+		Time nextPassengerAfter(Time t);
+
+		template<typename TIME>
+		Time firstPassengerAtOrAfter(TIME t) {
+			return nextPassengerAfter(lastWholeTimeBefore(t));
+		}
+
+	private:
+		const PassengerGenerator* src;
+		RandGen rand_gen;
+		Time last_departure;
+	};
+
+	/**
+	 * The passengers that leave at or after begin_time, and before end_time.
+	 */
 	template<typename TIME, typename PID_GENERATOR>
 	auto leavingDuringInterval(TIME begin_time, TIME end_time, PID_GENERATOR& pid_generator) const {
 		struct State : boost::equality_comparable<State> {
 			const PassengerGenerator* src;
+			DepartureCursor departures;
 			Time next_departure;
 			TIME end_time;
 
-			State(const PassengerGenerator* src, TrackNetwork::Time next_departure, TIME end_time)
+			State(const PassengerGenerator* src, TIME begin_time, TIME end_time)
 				: src(src)
-				, next_departure(next_departure)
+				, departures(*src)
+				, next_departure(departures.firstPassengerAtOrAfter(begin_time))
 				, end_time(end_time)
 			{ }
 
@@ -55,28 +91,58 @@ public:
 
 		return util::make_generator<State>(
 			// initial
-			State(this, nextPassengerAfter(begin_time), end_time),
+			State(this, begin_time, end_time),
 			// done
 			[](const State& s) {
 				return s.next_departure >= s.end_time;
 			},
 			// next
 			[](State&& s) {
-				s.next_departure = s.src->nextPassengerAfter(s.next_departure);
+				s.next_departure = s.departures.nextPassengerAfter(s.next_departure);
 				return s;
 			},
 			// transform
 			[&](const State& s) {
-				return instantiateAt(&s.src->statpsgr, pid_generator.gen_id(), s.next_departure);
+				return ::instantiateAt(&s.src->statpsgr, pid_generator.gen_id(), s.next_departure);
 			}
 		);
 	}
 
+	/**
+	 * The time of the first passenger that leaves strictly after t,
+	 * or the max Time if there never will be one.
+	 * Replays the random draws from time 0, so use a DepartureCursor to go
+	 * through many departures.
+	 */
+	Time nextPassengerAfter(TrackNetwork::Time t) const {
+		return DepartureCursor(*this).nextPassengerAfter(t);
+	}
+
+	/**
+	 * The time of the first passenger that leaves at or after t (which may be
+	 * fractional), or the max Time if there never will be one.
+	 */
+	template<typename TIME>
+	Time firstPassengerAtOrAfter(TIME t) const {
+		return nextPassengerAfter(lastWholeTimeBefore(t));
+	}
+
+	DepartureCursor makeDepartureCursor() const { return DepartureCursor(*this); }
+
+	Passenger instantiateAt(PassengerID id, Time t) const { return ::instantiateAt(&statpsgr, id, t); }
+
 private:
 	friend PassengerGeneratorFactory;
 	PassengerGenerator(const StatisticalPassenger& statpsgr, Seed seed);
 
-	Time nextPassengerAfter(TrackNetwork::Time t) const;
+	/**
+	 * Passengers only leave at whole times after 0, so the first one at or after
+	 * t is the first one after this.
+	 */
+	template<typename TIME>
+	static Time lastWholeTimeBefore(TIME t) {
+		return std::max<Time>(static_cast<Time>(std::ceil(t)) - 1, 0);
+	}
 
 	const StatisticalPassenger statpsgr;
 	const Seed seed;
@@ -59,6 +59,28 @@ inline std::vector<TrackNetwork::NodeID> get_shortest_route(
 	);
 }
 
+/**
+ * return the shortest route according to WEIGHT_MAP for each passenger in passengers,
+ * in the same order. Passengers that enter at the same vertex share one search.
+ */
+template<typename PASSENGERS, typename WEIGHT_MAP>
+std::vector<std::vector<TrackNetwork::NodeID>> get_shortest_routes(
+	const PASSENGERS& passengers,
+	const TrackNetwork& tn,
+	const WEIGHT_MAP& weight_map
+) {
+	std::vector<std::pair<TrackNetwork::NodeID, TrackNetwork::NodeID>> entry_exit_pairs;
+	for (const auto& p : passengers) {
+		entry_exit_pairs.emplace_back(p.getEntryID(), p.getExitID());
+	}
+
+	return get_shortest_routes(
+		entry_exit_pairs,
+		tn.g(),
+		weight_map
+	);
+}
+
 /**
  * determines the shortest route for each passenger, and stores it in a map keyed by the passenger
  */
@@ -67,13 +89,34 @@ inline std::unordered_map<Passenger,typename std::vector<TrackNetwork::NodeID>>
 ) {
 	std::unordered_map<Passenger,typename std::vector<TrackNetwork::NodeID>> passenger2route;
 
-	for (auto passenger : passengers) {
-		auto route = get_shortest_route(passenger.getEntryID(),passenger.getExitID(),network);
-		passenger2route.emplace(passenger,std::move(route));
+	auto routes = get_shortest_routes(
+		passengers,
+		network,
+		boost::get(&TrackNetwork::EdgeProperties::weight, network.g()) // default weight mapping
+	);
+
+	for (size_t ipassenger = 0; ipassenger != passengers.size(); ++ipassenger) {
+		passenger2route.emplace(passengers[ipassenger],std::move(routes[ipassenger]));
 	}
 	return passenger2route;
 }
 
+/**
+ * A ShortestPathOracle over a TrackNetwork, with bounds from the default weight mapping
+ */
+using TrackNetworkShortestPathOracle = ShortestPathOracle<TrackNetwork::BackingGraphType, TrackNetwork::Weight>;
+
+inline TrackNetworkShortestPathOracle make_shortest_path_oracle(
+	const TrackNetwork& network,
+	size_t num_landmarks = TrackNetworkShortestPathOracle::DEFAULT_NUM_LANDMARKS
+) {
+	return TrackNetworkShortestPathOracle(
+		network.g(),
+		boost::get(&TrackNetwork::EdgeProperties::weight, network.g()), // default weight mapping
+		num_landmarks
+	);
+}
+
 /**
  * iterates the route, calls func(os,elem) and uses operator<< to print the result of
  * a const char[x] to os, in the format
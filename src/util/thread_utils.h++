@@ -2,7 +2,10 @@
 #ifndef UTILS__THREAD_UTILS_H
 #define UTILS__THREAD_UTILS_H
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -132,6 +135,64 @@ private:
 	size_t outstanding_job_tokens;
 };
 
+/**
+ * A reasonable number of threads to use for CPU bound work. Never zero.
+ */
+inline size_t default_num_threads() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Calls f(i) for every i in [0, count), using up to num_threads threads
+ * (including the calling one). If num_threads is 0, uses default_num_threads().
+ *
+ * Indices are handed out one at a time, so threads that get cheap items just
+ * come back for more. Returns after every call has finished. If any call
+ * throws, the remaining indices are skipped, and the first exception is re-thrown here.
+ */
+template<typename FUNC>
+void parallel_for_index(size_t count, size_t num_threads, FUNC&& f) {
+	if (num_threads == 0) {
+		num_threads = default_num_threads();
+	}
+	num_threads = std::min(num_threads, count);
+
+	std::atomic<size_t> next_index(0);
+	std::mutex exception_mutex;
+	std::exception_ptr first_exception;
+
+	const auto worker = [&]() {
+		while (true) {
+			const auto i = next_index++;
+			if (i >= count) {
+				return;
+			}
+			try {
+				f(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(exception_mutex);
+				if (!first_exception) {
+					first_exception = std::current_exception();
+				}
+				next_index = count;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t ithread = 1; ithread < num_threads; ++ithread) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	if (first_exception) {
+		std::rethrow_exception(first_exception);
+	}
+}
+
 } // end namespace util
 
 #endif /* UTILS__THREAD_UTILS_H */